@@ -0,0 +1,68 @@
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "includes/corpus.hpp"
+
+// writes seeded synthetic texts (includes/corpus.hpp), e.g. stand-ins for the downloaded datasets
+//   generate_corpus uniform <length> <sigma> <seed> <out>
+//   generate_corpus english <length> <seed> <out>
+//   generate_corpus dna <length> <mutation_rate> <seed> <out>
+//   generate_corpus versioned <length> <num_versions> <mutation_rate> <seed> <out>  (versions of English-like text)
+//   generate_corpus standins  (./data/english.10MiB, ./data/dna.10MiB, ./data/sources.10MiB)
+
+void write(const std::string& path, const std::string& text){
+    std::ofstream file(path, std::ios::binary);
+    if(!file.is_open()){
+        std::cerr << "cannot open " << path << std::endl;
+        std::exit(1);
+    }
+    file.write(text.data(), text.size());
+    std::clog << path << ": " << text.size() << " bytes" << std::endl;
+}
+
+int main(int argc, char* argv[]){
+    auto usage = [&]{
+        std::cerr << "usage: " << argv[0] << " uniform <length> <sigma> <seed> <out>" << std::endl;
+        std::cerr << "       " << argv[0] << " english <length> <seed> <out>" << std::endl;
+        std::cerr << "       " << argv[0] << " dna <length> <mutation_rate> <seed> <out>" << std::endl;
+        std::cerr << "       " << argv[0] << " versioned <length> <num_versions> <mutation_rate> <seed> <out>" << std::endl;
+        std::cerr << "       " << argv[0] << " standins" << std::endl;
+        return 1;
+    };
+    if(argc < 2){
+        return usage();
+    }
+    if(strcmp(argv[1], "uniform") == 0 && argc == 6){
+        write(argv[5], corpus::uniform(std::stoull(argv[2]), std::stoul(argv[3]), std::stoull(argv[4])));
+    }
+    else if(strcmp(argv[1], "english") == 0 && argc == 5){
+        write(argv[4], corpus::english(std::stoull(argv[2]), std::stoull(argv[3])));
+    }
+    else if(strcmp(argv[1], "dna") == 0 && argc == 6){
+        write(argv[5], corpus::dna(std::stoull(argv[2]), std::stod(argv[3]), std::stoull(argv[4])));
+    }
+    else if(strcmp(argv[1], "versioned") == 0 && argc == 7){
+        std::uint64_t length = std::stoull(argv[2]);
+        int num_versions = std::stoi(argv[3]);
+        std::uint64_t seed = std::stoull(argv[5]);
+        std::string text = corpus::versioned(corpus::english(length / num_versions, seed), num_versions, std::stod(argv[4]), seed);
+        text.resize(std::min<std::uint64_t>(text.size(), length));
+        write(argv[6], text);
+    }
+    else if(strcmp(argv[1], "standins") == 0 && argc == 2){
+        // the file names the benchmarks read; "sources" is moderately repetitive, like a source tree
+        constexpr std::uint64_t length = 10 << 20;
+        write("./data/english.10MiB", corpus::english(length, 0));
+        write("./data/dna.10MiB", corpus::dna(length, 0.01, 0));
+        std::string sources = corpus::versioned(corpus::english(length / 8, 1), 8, 0.05, 1);
+        sources.resize(std::min<std::uint64_t>(sources.size(), length));
+        write("./data/sources.10MiB", sources);
+    }
+    else{
+        return usage();
+    }
+    return 0;
+}
@@ -0,0 +1,228 @@
+#ifndef PACKED_DAWG_ALPHABET_HPP
+#define PACKED_DAWG_ALPHABET_HPP
+
+#include <bit>
+#include <array>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include <string_view>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "lcp.hpp"
+
+using ULong = std::uint64_t;
+
+// Alphabet policies of the heavy-path indexes: how the text / hh_string is stored (Alphabet::String)
+// and how a pattern is compared against it. CHAR_BITS bits per symbol, ALPHA symbols per 64-bit word.
+template<unsigned int CharBits>
+struct AlphabetTraits{
+    static constexpr unsigned int CHAR_BITS = CharBits;
+    static constexpr unsigned int ALPHA = 64 / CharBits; // WORD_SIZE / CHAR_BITS;
+};
+
+// index of the first differing symbol of a xor of two words, ALPHA if equal
+template<typename Alphabet>
+inline unsigned int get_lsb_pos(ULong val){
+    if(val == 0){
+        return Alphabet::ALPHA;
+    }
+    unsigned int ctz = __builtin_ctzll(val);
+    return ctz / Alphabet::CHAR_BITS;
+}
+
+// lcp of str1[ofs1..] and str2[ofs2..], at most max_len; never reads past the end of either view.
+// The first word is compared inline (most heavy-path steps end there), longer runs go to the
+// dispatched SIMD kernel (lcp::current).
+inline unsigned int get_lcp(std::string_view str1, std::uint64_t ofs1, std::string_view str2, std::uint64_t ofs2, unsigned int max_len);
+
+// 8 bits per symbol, any byte
+struct ByteAlphabet : AlphabetTraits<8>{
+    class String{
+        std::string str;
+    public:
+        String() = default;
+        explicit String(std::string str) : str(std::move(str)){}
+        // lcp of str[pos..] and pattern[i..], at most max_len
+        unsigned int lcp(std::uint64_t pos, std::string_view pattern, unsigned int i, unsigned int max_len) const{
+            return get_lcp(str, pos, pattern, i, max_len);
+        }
+        void prefetch(std::uint64_t pos) const{
+            __builtin_prefetch(str.data() + pos);
+        }
+        std::uint64_t size() const{
+            return str.size();
+        }
+        const std::string& bytes() const{
+            return str;
+        }
+        std::uint64_t num_bytes() const{
+            return str.capacity() * sizeof(unsigned char) + 2 * sizeof(std::size_t);
+        }
+    };
+};
+
+inline unsigned int get_lcp(std::string_view str1, std::uint64_t ofs1, std::string_view str2, std::uint64_t ofs2, unsigned int max_len){
+    assert(ofs1 <= str1.length() && ofs2 <= str2.length());
+    max_len = std::min<std::size_t>({max_len, str1.length() - ofs1, str2.length() - ofs2});
+    const char* ptr1 = str1.data() + ofs1;
+    const char* ptr2 = str2.data() + ofs2;
+    if(max_len >= ByteAlphabet::ALPHA){
+        ULong x, y;
+        std::memcpy(&x, ptr1, sizeof(ULong));
+        std::memcpy(&y, ptr2, sizeof(ULong));
+        if(x != y){
+            return get_lsb_pos<ByteAlphabet>(x ^ y);
+        }
+    }
+    return lcp::current(ptr1, ptr2, max_len);
+}
+
+// 2 bits per symbol for A, C, G, T, code = bits 1-2 of the ASCII code (A0 C1 T2 G3).
+// Any other byte (N, the '\0' ending every heavy path of hh_string, ...) is an exception: a 1-bit flag per
+// symbol, with the byte itself in a sorted list unless it is '\0'. A run of symbols only matches while
+// neither side has an exception, except where both sides hold the same exceptional byte.
+// 3 bits per symbol instead of 8; the lcp compares ALPHA = 32 symbols per word.
+struct DNAAlphabet : AlphabetTraits<2>{
+    static constexpr ULong lo_bits = 0x0101010101010101ull;
+
+    // 0x80 in every zero byte of y, 0 elsewhere
+    static ULong zero_bytes(ULong y){
+        return ~(((y & (0x7F * lo_bits)) + 0x7F * lo_bits) | y | 0x7F * lo_bits);
+    }
+    // codes (2 bits each) and exception flags (1 bit each) of the 8 bytes of x
+    static std::pair<ULong, ULong> encode8(ULong x){
+        ULong valid = zero_bytes(x ^ ('A' * lo_bits)) | zero_bytes(x ^ ('C' * lo_bits)) | zero_bytes(x ^ ('G' * lo_bits)) | zero_bytes(x ^ ('T' * lo_bits));
+        ULong exceptions = (((~valid & (0x80 * lo_bits)) >> 7u) * 0x0102040810204080ull) >> 56u;
+        ULong codes = (x >> 1u) & (0x03 * lo_bits);
+        codes = (codes | codes >> 6u) & 0x000F000F000F000Full;
+        codes = (codes | codes >> 12u) & 0x000000FF000000FFull;
+        codes = (codes | codes >> 24u) & 0x000000000000FFFFull;
+        return {codes, exceptions};
+    }
+    // codes / exception flags of up to 32 bytes
+    static std::pair<ULong, ULong> encode(const char* ptr, unsigned int len){
+        ULong codes = 0, exceptions = 0;
+        for(unsigned int k = 0; k < len; k += 8){
+            ULong x = 0;
+            unsigned int bytes = std::min(8u, len - k);
+            std::memcpy(&x, ptr + k, bytes);
+            auto [c, e] = encode8(x);
+            codes |= c << (2 * k);
+            exceptions |= (e & ((1u << bytes) - 1)) << k;
+        }
+        return {codes, exceptions};
+    }
+
+#if defined(__x86_64__)
+    // checked once; full 32-byte chunks of a pattern are encoded with AVX2 + BMI2 when the CPU has them
+    static inline const bool has_avx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2"));
+
+    // encode(ptr, 32): cmpeq against A/C/G/T for the exceptions, movemask of ASCII bits 1 and 2 for the codes
+    __attribute__((target("avx2,bmi2")))
+    static std::pair<ULong, ULong> encode32_avx2(const char* ptr){
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+        __m256i valid = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('A')), _mm256_cmpeq_epi8(x, _mm256_set1_epi8('C'))),
+                _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('G')), _mm256_cmpeq_epi8(x, _mm256_set1_epi8('T'))));
+        auto exceptions = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(valid));
+        auto bit1 = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_slli_epi16(x, 6)));
+        auto bit2 = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_slli_epi16(x, 5)));
+        return {_pdep_u64(bit1, 0x5555555555555555ull) | _pdep_u64(bit2, 0xAAAAAAAAAAAAAAAAull), exceptions};
+    }
+
+    // the first len (< 32) bytes of ptr, zero-filled to 32 bytes
+    static std::array<char, 32> copy32(const char* ptr, unsigned int len){
+        std::array<char, 32> buf{};
+        std::memcpy(buf.data(), ptr, len);
+        return buf;
+    }
+#endif
+
+    class String{
+        std::uint64_t _size = 0;
+        // 32 codes per word, 64 flags per word, one padding word each
+        std::vector<ULong> codes;
+        std::vector<ULong> flags;
+        // (pos << 8) | byte, sorted: 8 bytes per exception for positions of up to 56 bits
+        std::vector<std::uint64_t> exceptions;
+
+        // 64 bits starting at bit `bit`
+        static ULong get_bits(const std::vector<ULong>& words, std::uint64_t bit){
+            ULong lo = words[bit >> 6u] >> (bit & 63u);
+            ULong hi = (words[(bit >> 6u) + 1] << 1u) << (63u - (bit & 63u));
+            return lo | hi;
+        }
+        char exception_at(std::uint64_t pos) const{
+            auto it = std::lower_bound(exceptions.begin(), exceptions.end(), pos << 8u);
+            return it != exceptions.end() && *it >> 8u == pos ? static_cast<char>(*it & 0xFFu) : '\0';
+        }
+    public:
+        String() = default;
+        explicit String(const std::string& str) : _size(str.size()), codes(str.size() / ALPHA + 2, 0), flags(str.size() / 64 + 2, 0){
+            for(std::uint64_t k = 0; k < str.size(); k += ALPHA){
+                unsigned int len = std::min<std::uint64_t>(ALPHA, str.size() - k);
+                auto [c, e] = encode(str.data() + k, len);
+                codes[k / ALPHA] = c;
+                flags[k / 64] |= e << (k % 64);
+                for(; e != 0; e &= e - 1){
+                    std::uint64_t pos = k + __builtin_ctzll(e);
+                    if(str[pos] != '\0'){
+                        exceptions.emplace_back(pos << 8u | static_cast<unsigned char>(str[pos]));
+                    }
+                }
+            }
+        }
+        unsigned int lcp(std::uint64_t pos, std::string_view pattern, unsigned int i, unsigned int max_len) const{
+            assert(pos <= _size && i <= pattern.length());
+            max_len = std::min<std::uint64_t>({max_len, _size - pos, pattern.length() - i});
+            unsigned int l = 0;
+            while(l < max_len){
+                unsigned int len = std::min(ALPHA, max_len - l);
+#if defined(__x86_64__)
+                auto [pattern_codes, pattern_exceptions] = !has_avx2 ? encode(pattern.data() + i + l, len)
+                        : len == ALPHA ? encode32_avx2(pattern.data() + i + l) : encode32_avx2(copy32(pattern.data() + i + l, len).data());
+#else
+                auto [pattern_codes, pattern_exceptions] = encode(pattern.data() + i + l, len);
+#endif
+                ULong diff = pattern_codes ^ get_bits(codes, 2 * (pos + l));
+                ULong text_exceptions = get_bits(flags, pos + l) & 0xFFFFFFFFull;
+                unsigned int mismatch = std::countr_zero((diff | diff >> 1u) & 0x5555555555555555ull) / 2;
+                unsigned int exception = std::countr_zero(text_exceptions | pattern_exceptions);
+                unsigned int stop = std::min({mismatch, exception, len});
+                l += stop;
+                if(stop == len){
+                    continue;
+                }
+                if(stop == exception && ((text_exceptions & pattern_exceptions) >> stop & 1u) && exception_at(pos + l) == pattern[i + l]){
+                    ++l;
+                    continue;
+                }
+                break;
+            }
+            return l;
+        }
+        void prefetch(std::uint64_t pos) const{
+            __builtin_prefetch(codes.data() + pos / ALPHA);
+        }
+        std::uint64_t size() const{
+            return _size;
+        }
+        std::uint64_t num_bytes() const{
+            std::uint64_t size = sizeof(_size);
+            size += codes.capacity() * sizeof(ULong) + 2 * sizeof(std::size_t);
+            size += flags.capacity() * sizeof(ULong) + 2 * sizeof(std::size_t);
+            size += exceptions.capacity() * sizeof(std::uint64_t) + 2 * sizeof(std::size_t);
+            return size;
+        }
+    };
+};
+
+#endif //PACKED_DAWG_ALPHABET_HPP
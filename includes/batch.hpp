@@ -0,0 +1,51 @@
+#ifndef PACKED_DAWG_BATCH_HPP
+#define PACKED_DAWG_BATCH_HPP
+
+#include <span>
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+constexpr int batch_width = 16;
+
+// Advances up to `width` queries in lockstep.
+// `start(pattern)` returns the initial State of a query, `step(state)` runs one stage of it and returns true once
+// `state.result` is final. A stage should end by prefetching what the next stage of the same query touches,
+// so that the miss is overlapped with the stages of the other in-flight queries.
+template<typename State, int width = batch_width, typename Start, typename Step>
+std::vector<decltype(State::result)> interleave(std::span<const std::string_view> patterns, Start start, Step step){
+    std::vector<decltype(State::result)> results(patterns.size());
+    std::array<State, width> states;
+    std::array<std::size_t, width> ids;
+    int active = 0;
+    std::size_t next = 0;
+    for(; active < width && next < patterns.size(); ++active, ++next){
+        ids[active] = next;
+        states[active] = start(patterns[next]);
+    }
+    while(active > 0){
+        for(int k = 0; k < active;){
+            if(!step(states[k])){
+                ++k;
+                continue;
+            }
+            results[ids[k]] = states[k].result;
+            if(next < patterns.size()){
+                ids[k] = next;
+                states[k] = start(patterns[next]);
+                ++next;
+                ++k;
+            }
+            else{
+                --active;
+                ids[k] = ids[active];
+                states[k] = states[active];
+            }
+        }
+    }
+    return results;
+}
+
+#endif //PACKED_DAWG_BATCH_HPP
@@ -0,0 +1,286 @@
+#ifndef PACKED_DAWG_CDAWG_HPP
+#define PACKED_DAWG_CDAWG_HPP
+
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <optional>
+#include <functional>
+#include <string_view>
+
+#include "full_text_index.hpp"
+#include "dawg.hpp"
+
+// Compact DAWG: the DAWG with every node of out-degree 1 that is not a suffix of the text merged into its
+// out-edge. The source, the sink, the branching nodes and the suffixes of the text remain: O(e) nodes for
+// e right extensions of the maximal repeats, far fewer than n on repetitive texts, and nothing is stored
+// per text position. The label of an edge into y is text[poses[y] - len, poses[y]), so an edge is (target, len).
+//
+// Heavy paths as in HeavyPathDAWG: each node keeps the edge that starts with its DAWG heavy edge, so the heavy
+// walk from x spells text[poses[x], n). The heavy tree is cut into paths of consecutive ids along which poses
+// increase; one get_lcp against the text runs through a light edge's label and the heavy walk after it, and the
+// node reached is found by binary search over poses.
+// A pattern ending inside an edge has the occurrences of the edge's target, shifted by the rest of the label.
+// locate enumerates the paths from the node to the sink, one per occurrence: a node is a suffix of the text
+// iff its count exceeds the sum over its children, so no positions are stored.
+// Int is the type of node ids and positions during construction and in the light edge maps, std::int64_t for texts
+// of 2^31 and more characters.
+template <template <typename, typename> typename MapType, typename Alphabet, typename Int = int>
+class BasicHeavyPathCDAWG : public BasicFullTextIndex<Int> {
+    typename Alphabet::String text;
+    Int source, sink;
+    // per node, in path order
+    PackedVector poses;
+    PackedVector path_last;
+    // heavy edge target (x + 1 inside a path), the sink points to itself
+    PackedVector heavy_to;
+    PackedVector counts;
+    // first label byte -> light edge id; the ids of node x are light_begin[x] .. light_begin[x + 1]
+    LightEdgeStorage<MapType, Int> light_edges;
+    PackedVector light_begin;
+    PackedVector edge_targets;
+    PackedVector edge_lengths;
+
+    // the last node on the heavy walk from x with poses <= q
+    std::uint64_t resolve(std::uint64_t x, std::uint64_t q) const{
+        while(true){
+            std::uint64_t last = path_last[x];
+            if(last != sink && poses[heavy_to[last]] <= q){
+                x = heavy_to[last];
+                continue;
+            }
+            std::uint64_t lo = x, hi = last;
+            while(lo < hi){
+                std::uint64_t mid = (lo + hi + 1) / 2;
+                if(poses[mid] <= q){
+                    lo = mid;
+                }
+                else{
+                    hi = mid - 1;
+                }
+            }
+            return lo;
+        }
+    }
+    // true if the whole pattern matches: it ends `offset` characters before `node` (inside the edge into node if
+    // offset > 0). Otherwise i is the length of the longest matching prefix, which ends at or inside the edge into node.
+    bool descend(std::string_view pattern, std::uint64_t& node, std::uint64_t& offset, unsigned int& i) const{
+        node = source;
+        offset = 0;
+        i = 0;
+        std::uint64_t p = poses[source];
+        while(true){
+            unsigned int lcp = text.lcp(p, pattern, i, pattern.length() - i);
+            i += lcp;
+            std::uint64_t q = p + lcp;
+            if(q < poses[node]){
+                // inside the label of the light edge into node
+                offset = poses[node] - q;
+                return i == pattern.length();
+            }
+            node = resolve(node, q);
+            if(poses[node] < q){
+                // inside the heavy edge out of node
+                node = heavy_to[node];
+                offset = poses[node] - q;
+                return i == pattern.length();
+            }
+            if(i == pattern.length()){
+                return true;
+            }
+            auto edge = light_edges.find(node, pattern[i]);
+            if(!edge){
+                return false;
+            }
+            node = edge_targets[edge.value()];
+            p = poses[node] - edge_lengths[edge.value()] + 1;
+            ++i;
+        }
+    }
+
+public:
+    explicit BasicHeavyPathCDAWG(std::string_view text) : BasicHeavyPathCDAWG(text, build_heavy_paths<Int>(text)) {}
+    BasicHeavyPathCDAWG(std::string_view text, const BasicHeavyPathBuilder<Int>& builder) : text(std::string(text)){
+        Int n = builder.n;
+        const auto& offsets = builder.edge_offsets;
+        // source, sink, branching nodes and the suffixes of the text
+        std::vector<char> kept(n, 0);
+        kept[0] = true;
+        for(Int x = builder.sink; x != -1; x = builder.slink[x]){
+            kept[x] = true;
+        }
+        for(Int x = 0; x < n; ++x){
+            if(offsets[x + 1] - offsets[x] >= 2){
+                kept[x] = true;
+            }
+        }
+        // first kept node on the unary chain from x, and its distance
+        std::vector<Int> dest(n), dist(n, 0);
+        for(auto it = builder.tps_order.rbegin(); it != builder.tps_order.rend(); ++it){
+            Int x = *it;
+            if(kept[x]){
+                dest[x] = x;
+                continue;
+            }
+            Int y = builder.edge_targets[offsets[x]];
+            dest[x] = dest[y];
+            dist[x] = dist[y] + 1;
+        }
+
+        // heavy tree over the kept nodes, each node continuing the path of its child with the most leaves
+        std::vector<Int> heavy_parent(n, -1), leaves(n, 0), best_child(n, -1);
+        for(Int x : builder.tps_order){
+            if(!kept[x]){
+                continue;
+            }
+            leaves[x] = std::max<Int>(leaves[x], 1);
+            if(x == builder.sink){
+                continue;
+            }
+            Int y = heavy_parent[x] = dest[builder.heavy_edge_to[x]];
+            leaves[y] += leaves[x];
+            if(best_child[y] == -1 || leaves[best_child[y]] < leaves[x]){
+                best_child[y] = x;
+            }
+        }
+        std::vector<Int> id(n, -1), nodes;
+        for(Int x = 0; x < n; ++x){
+            if(kept[x] && best_child[x] == -1){
+                for(Int v = x; ; v = heavy_parent[v]){
+                    id[v] = nodes.size();
+                    nodes.emplace_back(v);
+                    if(v == builder.sink || best_child[heavy_parent[v]] != v){
+                        break;
+                    }
+                }
+            }
+        }
+        Int m = nodes.size();
+        source = id[0];
+        sink = id[builder.sink];
+
+        std::vector<Int> poses_(m), path_last_(m), heavy_to_(m), counts_(m);
+        for(Int k = m - 1; k >= 0; --k){
+            Int x = nodes[k];
+            poses_[k] = builder.poses[x];
+            counts_[k] = builder.occ[x];
+            heavy_to_[k] = x == builder.sink ? k : id[heavy_parent[x]];
+            path_last_[k] = heavy_to_[k] == k + 1 ? path_last_[k + 1] : k;
+        }
+        // light edges as CSR by node, so the maps can be built in parallel
+        std::vector<Int> light_offsets(m + 1, 0);
+        std::vector<unsigned char> light_keys;
+        std::vector<Int> edge_targets_, edge_lengths_;
+        for(Int k = 0; k < m; ++k){
+            Int x = nodes[k];
+            for(auto e = offsets[x]; e < offsets[x + 1]; ++e){
+                if(builder.edge_targets[e] == builder.heavy_edge_to[x]){
+                    continue;
+                }
+                Int y = builder.edge_targets[e];
+                light_keys.emplace_back(builder.edge_labels[e]);
+                edge_targets_.emplace_back(id[dest[y]]);
+                edge_lengths_.emplace_back(dist[y] + 1);
+            }
+            light_offsets[k + 1] = light_keys.size();
+        }
+        poses = PackedVector(poses_);
+        path_last = PackedVector(path_last_);
+        heavy_to = PackedVector(heavy_to_);
+        counts = PackedVector(counts_);
+        light_begin = PackedVector(light_offsets);
+        edge_targets = PackedVector(edge_targets_);
+        edge_lengths = PackedVector(edge_lengths_);
+        light_edges = LightEdgeStorage<MapType, Int>(m, [&](Int k, auto& keys, auto& values){
+            for(Int e = light_offsets[k]; e < light_offsets[k + 1]; ++e){
+                keys.emplace_back(light_keys[e]);
+                values.emplace_back(e);
+            }
+        });
+        std::clog << "CDAWG |V|: " << m << " (DAWG " << n << "), |E|: " << m - 1 + edge_targets_.size() << " (DAWG " << builder.num_edges() << ")" << std::endl;
+    }
+
+    std::optional<Int> get_node(std::string_view pattern) const override{
+        std::uint64_t node, offset;
+        unsigned int i;
+        if(!descend(pattern, node, offset, i)){
+            return std::nullopt;
+        }
+        return node;
+    }
+    // the node of a prefix ending inside an edge is the edge's target
+    std::pair<std::uint64_t, Int> longest_prefix(std::string_view pattern) const override{
+        std::uint64_t node, offset;
+        unsigned int i;
+        descend(pattern, node, offset, i);
+        return {i, static_cast<Int>(node)};
+    }
+    std::uint64_t count(std::string_view pattern) const override{
+        auto node = get_node(pattern);
+        return node ? counts[node.value()] : 0;
+    }
+    void locate(std::string_view pattern, const std::function<void(std::uint64_t)>& callback) const override{
+        std::uint64_t node, offset;
+        unsigned int i;
+        if(!descend(pattern, node, offset, i)){
+            return;
+        }
+        // {node, length of the path to it}: a path to the sink spelling text[e, n) is an occurrence ending at e - offset
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> stack = {{node, 0}};
+        while(!stack.empty()){
+            auto [x, depth] = stack.back();
+            stack.pop_back();
+            std::uint64_t below = 0;
+            if(x != sink){
+                std::uint64_t y = heavy_to[x];
+                stack.emplace_back(y, depth + poses[y] - poses[x]);
+                below += counts[y];
+            }
+            for(std::uint64_t e = light_begin[x]; e < light_begin[x + 1]; ++e){
+                std::uint64_t y = edge_targets[e];
+                stack.emplace_back(y, depth + edge_lengths[e]);
+                below += counts[y];
+            }
+            if(below < counts[x]){
+                callback(text.size() - depth - offset - pattern.length());
+            }
+        }
+    }
+    std::uint64_t num_bytes() const override{
+        std::uint64_t size = sizeof(source) + sizeof(sink);
+        size += text.num_bytes();
+        size += poses.num_bytes();
+        size += path_last.num_bytes();
+        size += heavy_to.num_bytes();
+        size += counts.num_bytes();
+        size += light_edges.num_bytes();
+        size += light_begin.num_bytes();
+        size += edge_targets.num_bytes();
+        size += edge_lengths.num_bytes();
+        return size;
+    }
+};
+
+template <template <typename, typename> typename MapType>
+class HeavyPathCDAWG : public BasicHeavyPathCDAWG<MapType, ByteAlphabet> {
+public:
+    using BasicHeavyPathCDAWG<MapType, ByteAlphabet>::BasicHeavyPathCDAWG;
+};
+
+// text over A, C, G, T (plus rare other bytes) in 2 bits per symbol
+template <template <typename, typename> typename MapType>
+class DNAHeavyPathCDAWG : public BasicHeavyPathCDAWG<MapType, DNAAlphabet> {
+public:
+    using BasicHeavyPathCDAWG<MapType, DNAAlphabet>::BasicHeavyPathCDAWG;
+};
+
+// 64-bit node ids and positions, for texts of 2^31 and more characters
+template <template <typename, typename> typename MapType>
+class HeavyPathCDAWG64 : public BasicHeavyPathCDAWG<MapType, ByteAlphabet, std::int64_t> {
+public:
+    using BasicHeavyPathCDAWG<MapType, ByteAlphabet, std::int64_t>::BasicHeavyPathCDAWG;
+};
+
+#endif //PACKED_DAWG_CDAWG_HPP
@@ -0,0 +1,197 @@
+#ifndef PACKED_DAWG_CORPUS_HPP
+#define PACKED_DAWG_CORPUS_HPP
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+#include <string_view>
+
+// Seeded synthetic texts for the benchmarks, so that they run without downloaded data.
+// The same arguments give the same bytes on every platform: sampling is done here on top of std::mt19937_64,
+// whose output is fixed by the standard, instead of through the implementation-defined std distributions.
+namespace corpus {
+
+class Random{
+    std::mt19937_64 gen;
+public:
+    explicit Random(std::uint64_t seed) : gen(seed){}
+    // uniform in [0, n)
+    std::uint64_t below(std::uint64_t n){
+        return static_cast<std::uint64_t>((static_cast<unsigned __int128>(gen()) * n) >> 64u);
+    }
+    // uniform in [0, 1)
+    double real(){
+        return (gen() >> 11u) * 0x1.0p-53;
+    }
+    bool chance(double p){
+        return real() < p;
+    }
+    // index drawn with probability proportional to the weights, given as cumulative sums
+    std::uint64_t pick(const std::vector<double>& cumulative){
+        double r = real() * cumulative.back();
+        return std::min<std::uint64_t>(std::upper_bound(cumulative.begin(), cumulative.end(), r) - cumulative.begin(), cumulative.size() - 1);
+    }
+};
+
+inline std::vector<double> cumulative(const std::vector<double>& weights){
+    std::vector<double> res(weights.size());
+    double sum = 0;
+    for(std::size_t k = 0; k < weights.size(); ++k){
+        res[k] = sum += weights[k];
+    }
+    return res;
+}
+
+// i.i.d. uniform symbols from an alphabet of size sigma (1..255): letters and digits first, then the other bytes.
+// Byte 0 is never used: HeavyPathDAWG's hh_string marks the ends of heavy paths with it.
+inline std::string uniform(std::uint64_t length, unsigned int sigma, std::uint64_t seed){
+    assert(1 <= sigma && sigma <= 255);
+    std::string alphabet = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    for(int c = 1; c < 256; ++c){
+        if(alphabet.find(static_cast<char>(c)) == std::string::npos){
+            alphabet.push_back(static_cast<char>(c));
+        }
+    }
+    Random random(seed);
+    std::string res(length, '\0');
+    for(auto& c : res){
+        c = alphabet[random.below(sigma)];
+    }
+    return res;
+}
+
+// English-like text: a vocabulary of words spelt with English letter frequencies, drawn by Zipf's law
+// (exponent 1) or, half of the time, from a few favourite successors of the previous word (order-1 Markov),
+// in sentences with capitals, commas, full stops and paragraphs
+inline std::string english(std::uint64_t length, std::uint64_t seed, std::uint64_t vocabulary_size = 20'000){
+    Random random(seed);
+    const std::string letters = "abcdefghijklmnopqrstuvwxyz";
+    const auto letter_cdf = cumulative({8.2, 1.5, 2.8, 4.3, 12.7, 2.2, 2.0, 6.1, 7.0, 0.15, 0.77, 4.0, 2.4,
+                                        6.7, 7.5, 1.9, 0.095, 6.0, 6.3, 9.1, 2.8, 0.98, 2.4, 0.15, 2.0, 0.074});
+    // word lengths 1..12
+    const auto length_cdf = cumulative({3.0, 17.0, 20.0, 16.0, 11.0, 9.0, 8.0, 6.0, 4.0, 3.0, 2.0, 1.0});
+    std::vector<std::string> vocabulary(vocabulary_size);
+    for(auto& word : vocabulary){
+        std::uint64_t word_length = random.pick(length_cdf) + 1;
+        for(std::uint64_t k = 0; k < word_length; ++k){
+            word.push_back(letters[random.pick(letter_cdf)]);
+        }
+    }
+    std::vector<double> zipf(vocabulary_size);
+    for(std::uint64_t r = 0; r < vocabulary_size; ++r){
+        zipf[r] = 1.0 / (r + 1);
+    }
+    const auto zipf_cdf = cumulative(zipf);
+    constexpr int num_successors = 4;
+    std::vector<std::uint64_t> successors(vocabulary_size * num_successors);
+    for(auto& successor : successors){
+        successor = random.pick(zipf_cdf);
+    }
+
+    std::string res;
+    res.reserve(length + 64);
+    std::uint64_t word = random.pick(zipf_cdf);
+    while(res.size() < length){
+        std::uint64_t sentence_length = 5 + random.below(20);
+        for(std::uint64_t k = 0; k < sentence_length; ++k){
+            word = random.chance(0.5) ? successors[word * num_successors + random.below(num_successors)] : random.pick(zipf_cdf);
+            std::string_view spelling = vocabulary[word];
+            if(k == 0){
+                res.push_back(static_cast<char>(spelling[0] - 'a' + 'A'));
+                res.append(spelling.substr(1));
+            }
+            else{
+                res.push_back(' ');
+                res.append(spelling);
+                if(k + 1 < sentence_length && random.chance(0.07)){
+                    res.push_back(',');
+                }
+            }
+        }
+        res.push_back('.');
+        res.push_back(random.chance(0.1) ? '\n' : ' ');
+    }
+    res.resize(length);
+    return res;
+}
+
+// `edits` edits at distinct sorted positions in one pass: a third each substitutions, insertions and deletions,
+// new bytes copied from random positions of the text so its alphabet is kept
+inline std::string mutate(std::string_view text, std::uint64_t edits, Random& random){
+    if(text.empty()){
+        return std::string(text);
+    }
+    edits = std::min<std::uint64_t>(edits, text.length());
+    std::vector<std::uint64_t> positions(edits);
+    for(auto& pos : positions){
+        pos = random.below(text.length());
+    }
+    std::sort(positions.begin(), positions.end());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+    std::string res;
+    res.reserve(text.length() + positions.size());
+    std::uint64_t done = 0;
+    for(auto pos : positions){
+        res.append(text.substr(done, pos - done));
+        char c = text[random.below(text.length())];
+        switch(random.below(3)){
+            case 0:
+                res.push_back(c);
+                break;
+            case 1:
+                res.push_back(c);
+                res.push_back(text[pos]);
+                break;
+            default:
+                break;
+        }
+        done = pos + 1;
+    }
+    res.append(text.substr(done));
+    return res;
+}
+
+// DNA over ACGT: a random background into which copies of earlier segments (100..5000 bp) are inserted with point
+// mutations at mutation_rate, like the repeat families of a genome. About half of the sequence is such copies.
+inline std::string dna(std::uint64_t length, double mutation_rate, std::uint64_t seed){
+    constexpr std::string_view bases = "ACGT";
+    Random random(seed);
+    std::string res;
+    res.reserve(length + 5000);
+    while(res.size() < length){
+        if(res.size() >= 5000 && random.chance(0.3)){
+            std::uint64_t copy_length = 100 + random.below(4901);
+            std::uint64_t from = random.below(res.size() - copy_length);
+            std::string copy = res.substr(from, copy_length);
+            res += mutate(copy, static_cast<std::uint64_t>(std::llround(mutation_rate * copy_length)), random);
+        }
+        else{
+            for(int k = 0; k < 1000; ++k){
+                res.push_back(bases[random.below(4)]);
+            }
+        }
+    }
+    res.resize(length);
+    return res;
+}
+
+// highly repetitive versioned text: base followed by num_versions - 1 versions, each the previous one with
+// mutation_rate * length edits (substitutions, insertions, deletions)
+inline std::string versioned(std::string_view base, int num_versions, double mutation_rate, std::uint64_t seed){
+    assert(num_versions >= 1);
+    Random random(seed);
+    std::string version(base), res(base);
+    for(int v = 1; v < num_versions; ++v){
+        version = mutate(version, static_cast<std::uint64_t>(std::llround(mutation_rate * version.length())), random);
+        res += version;
+    }
+    return res;
+}
+
+}
+
+#endif //PACKED_DAWG_CORPUS_HPP
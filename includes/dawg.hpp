@@ -5,105 +5,393 @@
 #include <string>
 #include <map>
 #include <queue>
+#include <array>
 #include <cstring>
+#include <cassert>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
 
 #include "full_text_index.hpp"
 #include "sdsl/bp_support.hpp"
 #include "map.hpp"
 #include "vector.hpp"
+#include "image.hpp"
+#include "batch.hpp"
+#include "heavy_path_builder.hpp"
+#include "packed_vector.hpp"
+#include "locate.hpp"
+#include "matching_statistics.hpp"
+#include "alphabet.hpp"
+#include "light_edges.hpp"
+#include "level_ancestor.hpp"
+#include "prefix_table.hpp"
 
 
-using ULong = std::uint64_t;
-// constexpr unsigned int WORD_SIZE = 64;
-constexpr unsigned int CHAR_BITS = 8;
-constexpr unsigned int ALPHA = 8; // WORD_SIZE / CHAR_BITS;
+// light edges flattened into offsets/labels/targets (the layout of an on-disk image)
+struct FlatLightEdges{
+    std::vector<std::uint32_t> offsets;
+    std::vector<unsigned char> labels;
+    std::vector<int> targets;
 
-inline unsigned int get_lsb_pos(ULong val){
-    if(val == 0){
-        return ALPHA;
+    template <typename LightEdges>
+    explicit FlatLightEdges(const LightEdges& light_edges) : offsets(1, 0){
+        for(std::uint32_t i = 0; i < light_edges.size(); ++i){
+            for(auto [key, y] : light_edges.items(i)){
+                labels.emplace_back(key);
+                targets.emplace_back(y);
+            }
+            offsets.emplace_back(labels.size());
+        }
     }
-    unsigned int ctz = __builtin_ctzll(val);
-    return ctz / CHAR_BITS;
-}
+    void add_to(image::Writer& writer) const{
+        writer.add(image::Section::LightOffsets, std::span(offsets));
+        writer.add(image::Section::LightLabels, std::span(labels));
+        writer.add(image::Section::LightTargets, std::span(targets));
+    }
+};
 
-inline unsigned int get_lcp(std::string_view str1, unsigned int ofs1, std::string_view str2, unsigned int ofs2, unsigned int max_len){
-    unsigned int max_iter = max_len / ALPHA;
-    auto* ptr1 = reinterpret_cast<const ULong*>(str1.data() + ofs1);
-    auto* ptr2 = reinterpret_cast<const ULong*>(str2.data() + ofs2);
-    int i = 0;
-    while(*ptr1 == *ptr2 && i < max_iter){
-        ++i;
-        ++ptr1;
-        ++ptr2;
-    }
-    return std::min(i * ALPHA + get_lsb_pos(*ptr1 ^ *ptr2), max_len);
-}
+// Int is the type of node ids and lens: int, or std::int64_t for texts of 2^31 and more characters
+// (16 bytes per node and 8 per arena slot with int, 32 and 16 with std::int64_t).
+template<typename Int_>
+struct BasicDAWGBase{
+    // Transitions of all nodes live in one arena. Each node owns a power-of-two block of it, used as an
+    // open-addressing table with the same hashing and growth policy as DynamicHashMap.
+    // Blocks released on growth are recycled per size class, and cloning a node is a block copy.
+    using Int = Int_;
+    using Offset = std::make_unsigned_t<Int>;
+    using Edge = std::pair<unsigned char, Int>;
+    static constexpr std::uint64_t z = 65521;
+    static constexpr int max_block_log = 9;
 
-struct DAWGBase{
     struct Node{
-        DynamicHashMap<unsigned char, int> ch;
-        int slink, len;
-        explicit Node(int len) : slink(-1), len(len){}
+        Offset edges;
+        std::uint16_t num_edges;
+        std::uint8_t d;  // the block has 2^d slots, 0 if the node has no block yet
+        bool cloned;
+        Int slink, len;
+        explicit Node(Int len) : edges(0), num_edges(0), d(0), cloned(false), slink(-1), len(len){}
     };
 
     std::vector<Node> nodes;
-    int final_node = 0;
+    std::vector<Edge> arena;
+    std::array<std::vector<Offset>, max_block_log + 1> free_blocks;
+    Int final_node = 0;
 
-    explicit DAWGBase(std::string_view text){
+    // the automaton of the empty text, to be extended by add_node
+    BasicDAWGBase(){
         nodes.emplace_back(0);
-        for(int i = 0; i < text.size(); ++i){
+    }
+    explicit BasicDAWGBase(std::string_view text){
+        // up to 2 |text| nodes
+        assert(text.size() < static_cast<std::uint64_t>(std::numeric_limits<Int>::max()) / 2);
+        nodes.reserve(2 * text.size() + 1);
+        arena.reserve(4 * text.size() + 2);
+        nodes.emplace_back(0);
+        for(Int i = 0; i < static_cast<Int>(text.size()); ++i){
             add_node(i, text[i]);
         }
         nodes.shrink_to_fit();
+        for(auto& blocks : free_blocks){
+            blocks = std::vector<Offset>();
+        }
         std::clog << "DAWG Base construct end" << std::endl;
     }
 
-    void add_node(int i, unsigned char c){
-        int new_node = nodes.size();
-        int target_node = (nodes.size() == 1 ? 0 : final_node);
+    std::optional<Int> find(Int node, unsigned char c) const{
+        const Node& x = nodes[node];
+        if(x.d == 0){
+            return std::nullopt;
+        }
+        std::uint64_t mask = (1u << x.d) - 1;
+        for(std::uint64_t i = hash(c, x.d); arena[x.edges + i].second != -1; i = (i + 1) & mask){
+            if(arena[x.edges + i].first == c){
+                return arena[x.edges + i].second;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // transitions of the node, sorted by label
+    std::vector<Edge> items(Int node) const{
+        const Node& x = nodes[node];
+        std::vector<Edge> items;
+        items.reserve(x.num_edges);
+        for(std::uint32_t i = 0; i < (x.d ? (1u << x.d) : 0u); ++i){
+            if(arena[x.edges + i].second != -1){
+                items.emplace_back(arena[x.edges + i]);
+            }
+        }
+        std::sort(items.begin(), items.end());
+        return items;
+    }
+
+    template<typename Fn>
+    void for_each_edge(Int node, Fn fn) const{
+        const Node& x = nodes[node];
+        for(std::uint32_t i = 0; i < (x.d ? (1u << x.d) : 0u); ++i){
+            if(arena[x.edges + i].second != -1){
+                fn(arena[x.edges + i].first, arena[x.edges + i].second);
+            }
+        }
+    }
+
+    // nodes sorted by len: every edge x -> y has len[x] < len[y], so this is a topological order
+    std::vector<Int> topological_order() const{
+        Int n = nodes.size();
+        Int max_len = nodes[final_node].len;
+        std::vector<Int> len_cnt(max_len + 2, 0);
+        for(Int x = 0; x < n; ++x){
+            ++len_cnt[nodes[x].len + 1];
+        }
+        for(Int l = 0; l <= max_len; ++l){
+            len_cnt[l + 1] += len_cnt[l];
+        }
+        std::vector<Int> tps_order(n);
+        for(Int x = 0; x < n; ++x){
+            tps_order[len_cnt[nodes[x].len]++] = x;
+        }
+        return tps_order;
+    }
+
+    // |endpos(x)|, the number of occurrences of the strings of x:
+    // 1 if x is terminal (on the suffix-link path of the final node) plus the counts of its children
+    std::vector<Int> occurrence_counts(const std::vector<Int>& tps_order) const{
+        std::vector<Int> occ(nodes.size(), 0);
+        for(Int x = final_node; x != -1; x = nodes[x].slink){
+            occ[x] = 1;
+        }
+        for(auto it = tps_order.rbegin(); it != tps_order.rend(); ++it){
+            Int x = *it;
+            for_each_edge(x, [&](unsigned char, Int y){
+                occ[x] += occ[y];
+            });
+        }
+        return occ;
+    }
+
+    // End positions of all prefixes (the source and the non-cloned nodes) in suffix-link-tree preorder.
+    // The occurrences of node x end at positions[lo[x]], ..., positions[lo[x] + |endpos(x)| - 1].
+    void suffix_link_preorder(std::vector<Int>& lo, std::vector<Int>& positions) const{
+        Int n = nodes.size();
+        std::vector<Int> child_offsets(n + 1, 0);
+        for(Int x = 1; x < n; ++x){
+            ++child_offsets[nodes[x].slink + 1];
+        }
+        for(Int x = 0; x < n; ++x){
+            child_offsets[x + 1] += child_offsets[x];
+        }
+        std::vector<Int> children(n);
+        std::vector<Int> filled(child_offsets.begin(), child_offsets.end() - 1);
+        for(Int x = 1; x < n; ++x){
+            children[filled[nodes[x].slink]++] = x;
+        }
+        lo.assign(n, 0);
+        positions.clear();
+        positions.reserve(nodes[final_node].len + 1);
+        std::vector<Int> stack = {0};
+        while(!stack.empty()){
+            Int x = stack.back();
+            stack.pop_back();
+            lo[x] = positions.size();
+            if(!nodes[x].cloned){
+                positions.emplace_back(nodes[x].len);
+            }
+            for(Int k = child_offsets[x]; k < child_offsets[x + 1]; ++k){
+                stack.emplace_back(children[k]);
+            }
+        }
+    }
+
+    // appends c as text[i]; returns the node split off by a clone (the clone is then the last node), -1 if none
+    Int add_node(Int i, unsigned char c){
+        Int new_node = nodes.size();
+        Int target_node = (nodes.size() == 1 ? 0 : final_node);
         final_node = new_node;
         nodes.emplace_back(i + 1);
 
         for(; target_node != -1 &&
-              !nodes[target_node].ch.find(c).has_value(); target_node = nodes[target_node].slink){
-            nodes[target_node].ch.add(c, new_node);
+              !find(target_node, c).has_value(); target_node = nodes[target_node].slink){
+            add(target_node, c, new_node);
         }
         if(target_node == -1){
             nodes[new_node].slink = 0;
         }else{
-            int sp_node = nodes[target_node].ch.find(c).value();
+            Int sp_node = find(target_node, c).value();
             if(nodes[target_node].len + 1 == nodes[sp_node].len){
                 nodes[new_node].slink = sp_node;
             }else{
-                int clone_node = nodes.size();
+                Int clone_node = nodes.size();
                 nodes.emplace_back(nodes[target_node].len + 1);
-                nodes[clone_node].ch = nodes[sp_node].ch;
+                copy_edges(sp_node, clone_node);
+                nodes[clone_node].cloned = true;
                 nodes[clone_node].slink = nodes[sp_node].slink;
-                for(; target_node != -1 && nodes[target_node].ch.find(c).has_value() &&
-                      nodes[target_node].ch.find(c).value() == sp_node; target_node = nodes[target_node].slink){
-                    nodes[target_node].ch.add(c, clone_node);
+                for(; target_node != -1 && find(target_node, c) == sp_node; target_node = nodes[target_node].slink){
+                    add(target_node, c, clone_node);
                 }
                 nodes[sp_node].slink = nodes[new_node].slink = clone_node;
+                return sp_node;
             }
         }
+        return -1;
+    }
+
+    // Generalised construction over several strings, each started from the source (last = 0): the node of the
+    // strings of last followed by c. Unlike add_node it reuses or clones an existing transition, so no node
+    // spans two strings. final_node and the cloned flags are left to the caller.
+    Int extend(Int last, unsigned char c){
+        if(auto next = find(last, c)){
+            Int sp_node = next.value();
+            if(nodes[last].len + 1 == nodes[sp_node].len){
+                return sp_node;
+            }
+            Int clone_node = nodes.size();
+            nodes.emplace_back(nodes[last].len + 1);
+            copy_edges(sp_node, clone_node);
+            nodes[clone_node].cloned = true;
+            nodes[clone_node].slink = nodes[sp_node].slink;
+            for(Int target_node = last; target_node != -1 && find(target_node, c) == sp_node; target_node = nodes[target_node].slink){
+                add(target_node, c, clone_node);
+            }
+            nodes[sp_node].slink = clone_node;
+            return clone_node;
+        }
+        Int new_node = nodes.size();
+        nodes.emplace_back(nodes[last].len + 1);
+        Int target_node = last;
+        for(; target_node != -1 && !find(target_node, c).has_value(); target_node = nodes[target_node].slink){
+            add(target_node, c, new_node);
+        }
+        if(target_node == -1){
+            nodes[new_node].slink = 0;
+        }else{
+            Int sp_node = find(target_node, c).value();
+            if(nodes[target_node].len + 1 == nodes[sp_node].len){
+                nodes[new_node].slink = sp_node;
+            }else{
+                Int clone_node = nodes.size();
+                nodes.emplace_back(nodes[target_node].len + 1);
+                copy_edges(sp_node, clone_node);
+                nodes[clone_node].cloned = true;
+                nodes[clone_node].slink = nodes[sp_node].slink;
+                for(; target_node != -1 && find(target_node, c) == sp_node; target_node = nodes[target_node].slink){
+                    add(target_node, c, clone_node);
+                }
+                nodes[sp_node].slink = nodes[new_node].slink = clone_node;
+            }
+        }
+        return new_node;
+    }
+
+private:
+    static inline std::uint64_t hash(unsigned char c, int d){ return (z * c) & ((1u << d) - 1); }
+
+    Offset allocate(int d){
+        if(!free_blocks[d].empty()){
+            Offset block = free_blocks[d].back();
+            free_blocks[d].pop_back();
+            std::fill(arena.begin() + block, arena.begin() + block + (1u << d), Edge(0, -1));
+            return block;
+        }
+        Offset block = arena.size();
+        arena.resize(arena.size() + (1u << d), Edge(0, -1));
+        return block;
+    }
+
+    void insert(Node& x, unsigned char c, Int target){
+        std::uint64_t mask = (1u << x.d) - 1;
+        std::uint64_t i = hash(c, x.d);
+        for(; arena[x.edges + i].second != -1 && arena[x.edges + i].first != c; i = (i + 1) & mask);
+        x.num_edges += arena[x.edges + i].second == -1;
+        arena[x.edges + i] = {c, target};
+    }
+
+    void add(Int node, unsigned char c, Int target){
+        if(nodes[node].d == 0){
+            nodes[node].d = 1;
+            nodes[node].edges = allocate(1);
+        }
+        else if((1u << nodes[node].d) < ((nodes[node].num_edges + 1) * 2u)){
+            // grow: rehash into a block twice as large and recycle the old one
+            Node& x = nodes[node];
+            Offset old_block = x.edges;
+            int old_d = x.d;
+            assert(old_d < max_block_log);
+            Offset new_block = allocate(old_d + 1);
+            x.edges = new_block;
+            x.d = old_d + 1;
+            x.num_edges = 0;
+            for(std::uint32_t i = 0; i < (1u << old_d); ++i){
+                Edge e = arena[old_block + i];
+                if(e.second != -1){
+                    insert(x, e.first, e.second);
+                }
+            }
+            free_blocks[old_d].emplace_back(old_block);
+        }
+        insert(nodes[node], c, target);
+    }
+
+    void copy_edges(Int from, Int to){
+        int d = nodes[from].d;
+        nodes[to].d = d;
+        nodes[to].num_edges = nodes[from].num_edges;
+        if(d != 0){
+            Offset block = allocate(d);
+            std::copy_n(arena.begin() + nodes[from].edges, 1u << d, arena.begin() + block);
+            nodes[to].edges = block;
+        }
     }
 };
 
+using DAWGBase = BasicDAWGBase<int>;
+
+// where an LCP against hh_string has to stop in pattern[from..]: at the first '\0', which the text does not contain
+// but which would match the '\0' ending each heavy path (HeavyPathDAWG and its image)
+inline std::uint64_t hh_match_end(std::string_view pattern, std::uint64_t from = 0){
+    return std::min<std::uint64_t>(pattern.length(), pattern.find('\0', from));
+}
+
+// the DAWGBase is released before the indexes start materialising their own arrays
+template<typename Int = int>
+BasicHeavyPathBuilder<Int> build_heavy_paths(std::string_view text, bool locate = false){
+    return BasicHeavyPathBuilder<Int>(BasicDAWGBase<Int>(text), locate);
+}
+
 template <template <typename, typename> typename MapType> // requires std::is_base_of_v<Map, MapType>
-class SimpleDAWG : FullTextIndex {
+class SimpleDAWG : public FullTextIndex {
     Vector<MapType<unsigned char, int>, std::uint32_t> children;
+    PackedVector counts;
+    std::optional<LocateTable> occurrences;
+    PrefixTable prefix_table;
 public:
-    explicit SimpleDAWG(const DAWGBase& base) {
+    // locate: also build the LocateTable, without which locate() is unavailable
+    explicit SimpleDAWG(const DAWGBase& base, bool locate = false) : counts(base.occurrence_counts(base.topological_order())) {
+        if(locate){
+            std::vector<int> lo, positions;
+            base.suffix_link_preorder(lo, positions);
+            occurrences.emplace(lo, positions);
+        }
         std::vector<MapType<unsigned char, int>> children_;
-        for(auto& node : base.nodes){
-            children_.emplace_back(node.ch);
+        for(int x = 0; x < base.nodes.size(); ++x){
+            std::vector<unsigned char> keys;
+            std::vector<int> values;
+            for(auto [key, y] : base.items(x)){
+                keys.emplace_back(key);
+                values.emplace_back(y);
+            }
+            children_.emplace_back(keys, values);
         }
         children = children_;
     }
-    explicit SimpleDAWG(std::string_view text) : SimpleDAWG(DAWGBase(text)) {}
+    explicit SimpleDAWG(std::string_view text, bool locate = false) : SimpleDAWG(DAWGBase(text), locate) {}
     std::optional<int> get_node(std::string_view pattern) const override {
         int node = 0;
-        for(auto c : pattern){
+        unsigned int i = 0;
+        if(!prefix_table.seek(pattern, node, i)){
+            return std::nullopt;
+        }
+        for(auto c : pattern.substr(i)){
             auto res = children[node].find(c);
             if(res.has_value()){
                 node = res.value();
@@ -114,209 +402,340 @@ public:
         }
         return node;
     }
+    std::pair<std::uint64_t, int> longest_prefix(std::string_view pattern) const override{
+        int node = 0;
+        unsigned int i = 0;
+        prefix_table.seek(pattern, node, i);
+        for(; i < pattern.length(); ++i){
+            auto res = children[node].find(pattern[i]);
+            if(!res){
+                break;
+            }
+            node = res.value();
+        }
+        return {i, node};
+    }
+    std::uint64_t count(std::string_view pattern) const override{
+        auto node = get_node(pattern);
+        return node ? counts[node.value()] : 0;
+    }
+    void locate(std::string_view pattern, const std::function<void(std::uint64_t)>& callback) const override{
+        auto node = get_node(pattern);
+        if(node){
+            assert(occurrences);
+            occurrences->report(node.value(), counts[node.value()], pattern.length(), callback);
+        }
+    }
     virtual std::uint64_t num_bytes() const{
         std::uint64_t size = 0;
         size += decltype(children)::offset_bytes;
         for(int i = 0; i < children.size(); ++i){
             size += children[i].num_bytes();
         }
+        size += counts.num_bytes();
+        size += occurrences ? occurrences->num_bytes() : 0;
+        size += prefix_table.num_bytes();
         return size;
     }
+    // optional table of the nodes of all occurring strings of length <= k (1..4), used by get_node and longest_prefix
+    void build_prefix_table(unsigned int k){
+        prefix_table = PrefixTable(k, [&](std::string_view prefix){ return get_node(prefix); });
+    }
 };
 
-template <template <typename, typename> typename MapType> // requires std::is_base_of_v<Map, MapType>
-class HeavyTreeDAWG : FullTextIndex {
+// HeavyTreeDAWG with the text stored by an alphabet policy (ByteAlphabet, DNAAlphabet).
+// Int is the type of node ids and text positions, std::int64_t for texts of 2^31 and more characters;
+// the arrays are bit-packed either way, so it only widens the light edge maps and the prefix table.
+template <template <typename, typename> typename MapType, typename Alphabet, typename Int = int> // requires std::is_base_of_v<Map, MapType>
+class BasicHeavyTreeDAWG : public BasicFullTextIndex<Int> {
 protected:
-    std::string text;
-    std::string_view text_view;
-    std::vector<int> heavy_edge_to;
-    Vector<MapType<unsigned char, int>, std::uint32_t> light_edges;
-    Vector<int, std::uint32_t> poses;
+    typename Alphabet::String text;
+    // bit-packed, the sink points to itself
+    PackedVector heavy_edge_to;
+    LightEdgeStorage<MapType, Int> light_edges;
+    PackedVector poses;
+    PackedVector counts;
+    std::optional<LocateTable> occurrences;
+    SuffixLinks suffix_links;
+    BasicPrefixTable<Int> prefix_table;
 public:
-    explicit HeavyTreeDAWG(std::string_view text) : text(text), text_view(text) {
-        auto base = DAWGBase(text_view);
-        int n = base.nodes.size();
+    // locate: also build the LocateTable, without which locate() and occurrence() are unavailable
+    explicit BasicHeavyTreeDAWG(std::string_view text, bool locate = false) : BasicHeavyTreeDAWG(text, build_heavy_paths<Int>(text, locate)) {}
+    // with the LocateTable iff the builder was built with locate
+    BasicHeavyTreeDAWG(std::string_view text, const BasicHeavyPathBuilder<Int>& builder) : text(std::string(text)), poses(builder.poses), counts(builder.occ),
+            suffix_links(builder.n, {}, builder.slink, builder.len, [](Int y){ return y; }) {
+        if(!builder.locate_lo.empty()){
+            occurrences.emplace(builder.locate_lo, builder.locate_positions);
+        }
+        std::vector<Int> heavy_edge_to_(builder.heavy_edge_to);
+        heavy_edge_to_[builder.sink] = builder.sink;
+        heavy_edge_to = PackedVector(heavy_edge_to_);
+        light_edges = LightEdgeStorage<MapType, Int>(builder.n, [&](Int x, auto& keys, auto& values){
+            builder.light_edges_of(x, keys, values, [](Int y){ return y; });
+        });
+    }
 
-        std::vector<int> tps_order(n);
-        std::vector<int> in_degree(n, 0);
-        for(int x = 0; x < n; ++x){
-            for(auto [_key, y] : base.nodes[x].ch.items()){
-                ++in_degree[y];
-            }
+public:
+    std::optional<Int> get_node(std::string_view pattern) const override{
+        Int node = 0;
+        unsigned int i = 0;
+        if(!prefix_table.seek(pattern, node, i)){
+            return std::nullopt;
         }
-        std::queue<int> que;
-        que.emplace(0);
-        assert(in_degree[0] == 0);
-        int cnt = 0;
-        while(!que.empty()){
-            int x = que.front();
-            que.pop();
-            tps_order[cnt] = x;
-            ++cnt;
-            for(auto [_key, y] : base.nodes[x].ch.items()){
-                --in_degree[y];
-                if(in_degree[y] == 0){
-                    que.push(y);
-                }
+        while(i < pattern.length()){
+            std::uint64_t pos = poses[node];
+            int lcp = text.lcp(pos, pattern, i, pattern.length() - i);
+            node = get_anc(node, lcp);
+            i += lcp;
+            if(i == pattern.length()){
+                break;
+            }
+            auto light_to = light_edges.find(node, pattern[i]);
+            if(light_to){
+                node = light_to.value();
             }
+            else{
+                return std::nullopt;
+            }
+            ++i;
         }
-        assert(tps_order.size() == n);
-        std::vector<int> path_cnt(n, 0);
-        std::vector<int> poses_(n, 0);
-        int sink = tps_order.back();
-        // assert(sink == base.node_ids.back());
-        path_cnt[sink] = 1;
-        poses_[sink] = text.size();
-        std::vector<unsigned char> heavy_edge_label(n, 0);
-        heavy_edge_to.resize(n, -1);
-        for(auto it = tps_order.rbegin(); it != tps_order.rend(); ++it){
-            int x = *it;
-            int path_cnt_max = 0;
-            for(auto [key, y] : base.nodes[x].ch.items()){
-                path_cnt[x] += path_cnt[y];
-                if(path_cnt_max < path_cnt[y]){
-                    path_cnt_max = path_cnt[y];
-                    heavy_edge_to[x] = y;
-                    assert(poses_[y] != -1);
-                    poses_[x] = poses_[y] - 1;
-                    heavy_edge_label[x] = key;
-                }
+        return node;
+    }
+    std::pair<std::uint64_t, Int> longest_prefix(std::string_view pattern) const override{
+        Int node = 0;
+        unsigned int i = 0;
+        prefix_table.seek(pattern, node, i);
+        while(i < pattern.length()){
+            std::uint64_t pos = poses[node];
+            int lcp = text.lcp(pos, pattern, i, pattern.length() - i);
+            node = get_anc(node, lcp);
+            i += lcp;
+            if(i == pattern.length()){
+                break;
             }
-            assert(1 <= path_cnt[x] && path_cnt[x] <= n);
+            auto light_to = light_edges.find(node, pattern[i]);
+            if(!light_to){
+                break;
+            }
+            node = light_to.value();
+            ++i;
         }
-        std::vector<MapType<unsigned char, int>> light_edges_;
-        for(int x = 0; x < n; ++x){
-            std::vector<unsigned char> keys;
-            std::vector<int> values;
-            for(auto [key, y] : base.nodes[x].ch.items()){
-                if(heavy_edge_label[x] != key){
-                    keys.emplace_back(key);
-                    values.emplace_back(y);
+        return {i, node};
+    }
+    std::vector<std::optional<Int>> get_nodes(std::span<const std::string_view> patterns) const override{
+        // Pos: poses[node] -> Extend: text[pos..] -> MapHeader: light_edges[node] -> Light: the map's items
+        enum Stage { Pos, Extend, MapHeader, Light };
+        struct State {
+            std::string_view pattern;
+            Int node;
+            unsigned int i;
+            std::uint64_t pos;
+            Stage stage;
+            std::optional<Int> result;
+        };
+        return interleave<State>(patterns, [&](std::string_view pattern){
+            __builtin_prefetch(pattern.data());
+            poses.prefetch(0);
+            return State{pattern, 0, 0, 0, Pos, std::nullopt};
+        }, [&](State& s){
+            switch(s.stage){
+                case Pos:
+                    s.pos = poses[s.node];
+                    text.prefetch(s.pos);
+                    s.stage = Extend;
+                    return false;
+                case Extend: {
+                    int lcp = text.lcp(s.pos, s.pattern, s.i, s.pattern.length() - s.i);
+                    s.node = get_anc(s.node, lcp);
+                    s.i += lcp;
+                    if(s.i == s.pattern.length()){
+                        s.result = s.node;
+                        return true;
+                    }
+                    light_edges.prefetch_header(s.node);
+                    s.stage = MapHeader;
+                    return false;
+                }
+                case MapHeader:
+                    light_edges.prefetch(s.node);
+                    s.stage = Light;
+                    return false;
+                case Light: {
+                    auto light_to = light_edges.find(s.node, s.pattern[s.i]);
+                    if(!light_to){
+                        return true;
+                    }
+                    s.node = light_to.value();
+                    ++s.i;
+                    if(s.i == s.pattern.length()){
+                        s.result = s.node;
+                        return true;
+                    }
+                    poses.prefetch(s.node);
+                    __builtin_prefetch(s.pattern.data() + s.i);
+                    s.stage = Pos;
+                    return false;
                 }
             }
-            light_edges_.emplace_back(keys, values);
-        }
-        poses = poses_;
-        light_edges = light_edges_;
+            return true;
+        });
     }
-
-public:
-    std::optional<int> get_node(std::string_view pattern) const override{
-        unsigned int node = 0;
-        for(unsigned int i = 0; i < pattern.length();){
-            int pos = poses[node];
-            int lcp = get_lcp(text_view, pos, pattern, i, std::min(text.length() - pos, pattern.length() - i));
+    // callback(i, l): l is the length of the longest suffix of query[0..i] that occurs in the text.
+    // One left-to-right pass: heavy-path LCP jumps extend the match, suffix links shorten it.
+    void matching_statistics(std::string_view query, const std::function<void(std::uint64_t, std::uint64_t)>& callback) const{
+        Int node = 0;
+        std::uint64_t length = 0;
+        for(std::uint64_t i = 0; i < query.length();){
+            std::uint64_t pos = poses[node];
+            int lcp = text.lcp(pos, query, i, query.length() - i);
             node = get_anc(node, lcp);
+            for(int k = 0; k < lcp; ++k){
+                callback(i + k, ++length);
+            }
             i += lcp;
-            if(i == pattern.length()){
+            if(i == query.length()){
                 break;
             }
-            auto light_to = light_edges[node].find(pattern[i]);
+            auto light_to = light_edges.find(node, query[i]);
             if(light_to){
                 node = light_to.value();
+                callback(i, ++length);
+                ++i;
+            }
+            else if(node == 0){
+                callback(i, 0);
+                ++i;
             }
             else{
-                return std::nullopt;
+                length = suffix_links.length(node);
+                node = suffix_links.target(node);
             }
-            ++i;
         }
-        return node;
     }
-    virtual inline int get_anc(int node, int k) const{
+    virtual inline Int get_anc(Int node, int k) const{
         for(int i = 0; i < k; ++i){
             node = heavy_edge_to[node];
         }
         return node;
     }
+    void save(const std::string& path) const{
+        static_assert(std::is_same_v<Alphabet, ByteAlphabet>, "images store the text as bytes");
+        static_assert(sizeof(Int) == 4, "images store 32-bit node ids");
+        image::Writer writer(image::Kind::HeavyTree, text.size(), poses.size(), 0);
+        FlatLightEdges flat(light_edges);
+        writer.add(image::Section::Text, std::span(text.bytes()));
+        auto poses_ = poses.to_vector<int>();
+        auto heavy_edge_to_ = heavy_edge_to.to_vector<int>();
+        writer.add(image::Section::Poses, std::span(poses_));
+        writer.add(image::Section::HeavyEdgeTo, std::span(heavy_edge_to_));
+        auto counts_image = counts.image();
+        writer.add(image::Section::Counts, std::span(counts_image));
+        std::vector<std::uint64_t> lo_image, positions_image;
+        if(occurrences){
+            lo_image = occurrences->lo_array().image();
+            positions_image = occurrences->positions_array().image();
+            writer.add(image::Section::LocateLo, std::span(lo_image));
+            writer.add(image::Section::LocatePositions, std::span(positions_image));
+        }
+        flat.add_to(writer);
+        writer.write(path);
+    }
+    std::uint64_t count(std::string_view pattern) const override{
+        auto node = get_node(pattern);
+        return node ? counts[node.value()] : 0;
+    }
+    void locate(std::string_view pattern, const std::function<void(std::uint64_t)>& callback) const override{
+        auto node = get_node(pattern);
+        if(node){
+            assert(occurrences);
+            occurrences->report(node.value(), counts[node.value()], pattern.length(), callback);
+        }
+    }
+    // start of one occurrence of the length-`length` string of `node`, e.g. a node from longest_prefix
+    std::uint64_t occurrence(Int node, std::uint64_t length) const{
+        assert(occurrences);
+        return occurrences->first(node, length);
+    }
     virtual std::uint64_t num_bytes() const{
         std::uint64_t size = 0;
-        size += text.capacity() * sizeof(unsigned char) + 2 * sizeof(std::size_t);
-        size += 2 * sizeof(std::size_t);
-        size += heavy_edge_to.capacity() * sizeof(int) + 2 * sizeof(std::size_t);
-        size += light_edges.offset_bytes;
-        for(int i = 0; i < light_edges.size(); ++i){
-            size += light_edges[i].num_bytes();
-        }
+        size += text.num_bytes();
+        size += heavy_edge_to.num_bytes();
+        size += light_edges.num_bytes();
         size += poses.num_bytes();
+        size += counts.num_bytes();
+        size += occurrences ? occurrences->num_bytes() : 0;
+        size += suffix_links.num_bytes();
+        size += prefix_table.num_bytes();
         return size;
     }
+    // optional table of the nodes of all occurring strings of length <= k (1..4), used by get_node and longest_prefix
+    void build_prefix_table(unsigned int k){
+        prefix_table = BasicPrefixTable<Int>(k, [&](std::string_view prefix){ return get_node(prefix); });
+    }
+};
+
+template <template <typename, typename> typename MapType>
+class HeavyTreeDAWG : public BasicHeavyTreeDAWG<MapType, ByteAlphabet> {
+public:
+    using BasicHeavyTreeDAWG<MapType, ByteAlphabet>::BasicHeavyTreeDAWG;
+};
+
+// text over A, C, G, T (plus rare other bytes) in 2 bits per symbol
+template <template <typename, typename> typename MapType>
+class DNAHeavyTreeDAWG : public BasicHeavyTreeDAWG<MapType, DNAAlphabet> {
+public:
+    using BasicHeavyTreeDAWG<MapType, DNAAlphabet>::BasicHeavyTreeDAWG;
+};
+
+// 64-bit node ids and text positions, for texts of 2^31 and more characters
+template <template <typename, typename> typename MapType>
+class HeavyTreeDAWG64 : public BasicHeavyTreeDAWG<MapType, ByteAlphabet, std::int64_t> {
+public:
+    using BasicHeavyTreeDAWG<MapType, ByteAlphabet, std::int64_t>::BasicHeavyTreeDAWG;
+};
+
+// HeavyTreeDAWG whose get_anc is a LevelAncestor query over the heavy tree instead of a walk,
+// so a long heavy-path step costs a constant number of loads instead of one per character
+template <template <typename, typename> typename MapType>
+class HeavyTreeDAWGWithLA : public HeavyTreeDAWG<MapType> {
+    static constexpr int walk_limit = 16;
+    LevelAncestor level_ancestor;
+public:
+    explicit HeavyTreeDAWGWithLA(std::string_view text, bool locate = false) : HeavyTreeDAWGWithLA(text, build_heavy_paths(text, locate)) {}
+    HeavyTreeDAWGWithLA(std::string_view text, const HeavyPathBuilder& builder) : HeavyTreeDAWG<MapType>(text, builder), level_ancestor(builder.heavy_edge_to) {}
+
+    inline int get_anc(int node, int k) const override{
+        // a few dependent loads of heavy_edge_to beat the three of a ladder lookup
+        if(k <= walk_limit){
+            return HeavyTreeDAWG<MapType>::get_anc(node, k);
+        }
+        return level_ancestor.ancestor(node, k);
+    }
+    std::uint64_t num_bytes() const override{
+        return HeavyTreeDAWG<MapType>::num_bytes() + level_ancestor.num_bytes();
+    }
 };
 
 template <template <typename, typename> typename MapType> // requires std::is_base_of_v<Map, MapType>
-class HeavyTreeDAWGWithLABP : FullTextIndex {
+class HeavyTreeDAWGWithLABP : public FullTextIndex {
 protected:
     std::string text;
     std::string_view text_view;
     int source;
-    Vector<MapType<unsigned char, int>, std::uint32_t> light_edges;
-    Vector<int, std::uint32_t> poses;
+    LightEdgeStorage<MapType> light_edges;
+    PackedVector poses;
+    // indexed by preorder rank like poses
+    PackedVector counts;
+    std::optional<LocateTable> occurrences;
     sdsl::bit_vector bp;
     sdsl::bp_support_sada<> rich_bp;
+    PrefixTable prefix_table;
 public:
-    explicit HeavyTreeDAWGWithLABP(std::string_view text) : text(text), text_view(text) {
-        auto base = DAWGBase(text_view);
-        int n = base.nodes.size();
-
-        std::vector<int> tps_order(n);
-        std::vector<int> in_degree(n, 0);
-        for(int x = 0; x < n; ++x){
-            for(auto [_key, y] : base.nodes[x].ch.items()){
-                ++in_degree[y];
-            }
-        }
-        std::queue<int> que;
-        que.emplace(0);
-        assert(in_degree[0] == 0);
-        int cnt = 0;
-        while(!que.empty()){
-            int x = que.front();
-            que.pop();
-            tps_order[cnt] = x;
-            ++cnt;
-            for(auto [_key, y] : base.nodes[x].ch.items()){
-                --in_degree[y];
-                if(in_degree[y] == 0){
-                    que.push(y);
-                }
-            }
-        }
-        assert(tps_order.size() == n);
-        std::vector<int> path_cnt(n, 0);
-        std::vector<int> poses_(n, -1);
-        int sink = tps_order.back();
-        // assert(sink == base.node_ids.back());
-        path_cnt[sink] = 1;
-        poses_[sink] = text.size();
-        std::vector<unsigned char> heavy_edge_label(n, 0);
-        std::vector<int> heavy_edge_to(n, -1);
-        for(auto it = tps_order.rbegin(); it != tps_order.rend(); ++it){
-            int x = *it;
-            int path_cnt_max = 0;
-            for(auto [key, y] : base.nodes[x].ch.items()){
-                path_cnt[x] += path_cnt[y];
-                if(path_cnt_max < path_cnt[y]){
-                    path_cnt_max = path_cnt[y];
-                    heavy_edge_to[x] = y;
-                    assert(poses_[y] != -1);
-                    poses_[x] = poses_[y] - 1;
-                    heavy_edge_label[x] = key;
-                }
-            }
-            assert(1 <= path_cnt[x] && path_cnt[x] <= n);
-        }
-        std::vector<MapType<unsigned char, int>> light_edges_;
-        for(int x = 0; x < n; ++x){
-            std::vector<unsigned char> keys;
-            std::vector<int> values;
-            for(auto [key, y] : base.nodes[x].ch.items()){
-                if(heavy_edge_label[x] != key){
-                    keys.emplace_back(key);
-                    values.emplace_back(y);
-                }
-            }
-            light_edges_.emplace_back(keys, values);
-        }
-        light_edges = light_edges_;
+    // locate: also build the LocateTable, without which locate() is unavailable
+    explicit HeavyTreeDAWGWithLABP(std::string_view text, bool locate = false) : HeavyTreeDAWGWithLABP(text, build_heavy_paths(text, locate)) {}
+    HeavyTreeDAWGWithLABP(std::string_view text, const HeavyPathBuilder& builder) : text(text), text_view(this->text) {
+        int n = builder.n;
+        const auto& heavy_edge_to = builder.heavy_edge_to;
 
         int root;
         std::vector<int> indexes(2 * n, -1);
@@ -332,7 +751,7 @@ public:
 
         bp = sdsl::bit_vector (2 * n, 0);
 
-        cnt = 0;
+        int cnt = 0;
         int cnt2 = 0;
         std::vector<int> indexes_fl(n, 0);
         std::stack<std::pair<int, bool>> stack;
@@ -360,26 +779,40 @@ public:
         rich_bp = sdsl::bp_support_sada<>(&bp);
         source = indexes[0];
 
-        decltype(light_edges_) light_edges__(n);
-        decltype(poses_) poses__(n);
-        for(int i = 0; i < n; ++i){
-            std::vector<unsigned char> keys;
-            std::vector<int> values;
-            for(auto [k, v] : light_edges_[i].items()){
-                keys.emplace_back(k);
-                values.emplace_back(indexes[v]);
+        std::vector<int> preorder(n);
+        for(int x = 0; x < n; ++x){
+            preorder[indexes_fl[x]] = x;
+        }
+        std::vector<int> poses_(n);
+        for(int k = 0; k < n; ++k){
+            poses_[k] = builder.poses[preorder[k]];
+        }
+        poses = PackedVector(poses_);
+        std::vector<int> counts_(n);
+        for(int k = 0; k < n; ++k){
+            counts_[k] = builder.occ[preorder[k]];
+        }
+        counts = PackedVector(counts_);
+        if(!builder.locate_lo.empty()){
+            std::vector<int> lo(n);
+            for(int k = 0; k < n; ++k){
+                lo[k] = builder.locate_lo[preorder[k]];
             }
-            light_edges__[indexes_fl[i]] = MapType(keys, values);
-            poses__[indexes_fl[i]] = poses_[i];
+            occurrences.emplace(lo, builder.locate_positions);
         }
-        light_edges = light_edges__;
-        poses = poses__;
+        light_edges = LightEdgeStorage<MapType>(n, [&](int k, auto& keys, auto& values){
+            builder.light_edges_of(preorder[k], keys, values, [&](int y){ return indexes[y]; });
+        });
     }
 
 public:
     std::optional<int> get_node(std::string_view pattern) const override{
         unsigned int node = source;
-        for(unsigned int i = 0; i < pattern.length();){
+        unsigned int i = 0;
+        if(!prefix_table.seek(pattern, node, i)){
+            return std::nullopt;
+        }
+        while(i < pattern.length()){
             int pos = poses[rich_bp.rank(node-1)];
             int lcp = get_lcp(text_view, pos, pattern, i, std::min(text.length() - pos, pattern.length() - i));
             node = rich_bp.level_anc(node, lcp);
@@ -387,7 +820,7 @@ public:
             if(i == pattern.length()){
                 break;
             }
-            auto light_to = light_edges[rich_bp.rank(node-1)].find(pattern[i]);
+            auto light_to = light_edges.find(rich_bp.rank(node-1), pattern[i]);
             if(light_to){
                 node = light_to.value();
             }
@@ -398,77 +831,177 @@ public:
         }
         return node;
     }
+    std::pair<std::uint64_t, int> longest_prefix(std::string_view pattern) const override{
+        unsigned int node = source;
+        unsigned int i = 0;
+        prefix_table.seek(pattern, node, i);
+        while(i < pattern.length()){
+            int pos = poses[rich_bp.rank(node-1)];
+            int lcp = get_lcp(text_view, pos, pattern, i, std::min(text.length() - pos, pattern.length() - i));
+            node = rich_bp.level_anc(node, lcp);
+            i += lcp;
+            if(i == pattern.length()){
+                break;
+            }
+            auto light_to = light_edges.find(rich_bp.rank(node-1), pattern[i]);
+            if(!light_to){
+                break;
+            }
+            node = light_to.value();
+            ++i;
+        }
+        return {i, node};
+    }
+    std::uint64_t count(std::string_view pattern) const override{
+        auto node = get_node(pattern);
+        return node ? counts[rich_bp.rank(node.value() - 1)] : 0;
+    }
+    void locate(std::string_view pattern, const std::function<void(std::uint64_t)>& callback) const override{
+        auto node = get_node(pattern);
+        if(node){
+            auto k = rich_bp.rank(node.value() - 1);
+            assert(occurrences);
+            occurrences->report(k, counts[k], pattern.length(), callback);
+        }
+    }
     virtual std::uint64_t num_bytes() const{
         std::uint64_t size = 0;
         size += text.capacity() * sizeof(unsigned char) + 2 * sizeof(std::size_t);
-        size += decltype(light_edges)::offset_bytes;
-        for(int i = 0; i < light_edges.size(); ++i){
-            size += light_edges[i].num_bytes();
-        }
+        size += light_edges.num_bytes();
         size += poses.num_bytes();
+        size += counts.num_bytes();
+        size += occurrences ? occurrences->num_bytes() : 0;
         std::ofstream of("/dev/null");
         size += bp.serialize(of);
         size += rich_bp.serialize(of);
+        size += prefix_table.num_bytes();
         return size;
     }
+    // optional table of the nodes of all occurring strings of length <= k (1..4), used by get_node and longest_prefix
+    void build_prefix_table(unsigned int k){
+        prefix_table = PrefixTable(k, [&](std::string_view prefix){ return get_node(prefix); });
+    }
 };
 
-
-template <template <typename, typename> typename MapType> // requires std::is_base_of_v<Map, MapType>
-class HeavyPathDAWG : FullTextIndex {
-    std::string hh_string;
-    Vector<MapType<unsigned char, int>, std::uint32_t> light_edges;
-    int source;
+// HeavyTreeDAWGWithLABP without rank queries: nodes are addressed by preorder rank, and the BP position
+// needed by level_anc is recovered arithmetically. The heavy tree is rooted at the sink, so the depth of
+// rank r is |text| - poses[r], and an open parenthesis at position p of depth d has rank (p + d) / 2.
+// A hop reads poses and the light edges directly and costs one level_anc; the footprint is unchanged.
+template <template <typename, typename> typename MapType>
+class HeavyTreeDAWGWithLABPRankFree : public HeavyTreeDAWGWithLABP<MapType> {
+    using Base = HeavyTreeDAWGWithLABP<MapType>;
+    std::uint64_t rank_of(std::uint64_t bp_pos) const{
+        return bp_pos == 0 ? 0 : this->rich_bp.rank(bp_pos - 1);
+    }
 public:
-    explicit HeavyPathDAWG(std::string_view text){
-        DAWGBase base(text);
-        int n = base.nodes.size();
-        std::vector<int> tps_order(n);
-        std::vector<int> in_degree(n, 0);
-        for(int x = 0; x < n; ++x){
-            for(auto [_key, y] : base.nodes[x].ch.items()){
-                ++in_degree[y];
+    explicit HeavyTreeDAWGWithLABPRankFree(std::string_view text, bool locate = false) : HeavyTreeDAWGWithLABPRankFree(text, build_heavy_paths(text, locate)) {}
+    HeavyTreeDAWGWithLABPRankFree(std::string_view text, const HeavyPathBuilder& builder) : Base(text, builder) {
+        // light edge targets and the source as ranks instead of BP positions
+        auto light_edges = std::move(this->light_edges);
+        this->light_edges = LightEdgeStorage<MapType>(light_edges.size(), [&](int k, auto& keys, auto& values){
+            for(auto [key, y] : light_edges.items(k)){
+                keys.emplace_back(key);
+                values.emplace_back(rank_of(y));
             }
+        });
+        this->source = rank_of(this->source);
+    }
+
+    std::optional<int> get_node(std::string_view pattern) const override{
+        std::uint64_t node = this->source;
+        unsigned int i = 0;
+        if(!this->prefix_table.seek(pattern, node, i)){
+            return std::nullopt;
         }
-        std::queue<int> que;
-        que.emplace(0);
-        assert(in_degree[0] == 0);
-        int cnt = 0;
-        while(!que.empty()){
-            int x = que.front();
-            que.pop();
-            tps_order[cnt] = x;
-            ++cnt;
-            for(auto [_key, y] : base.nodes[x].ch.items()){
-                --in_degree[y];
-                if(in_degree[y] == 0){
-                    que.push(y);
-                }
+        while(i < pattern.length()){
+            std::uint64_t pos = this->poses[node];
+            std::uint64_t depth = this->text.length() - pos;
+            int lcp = get_lcp(this->text_view, pos, pattern, i, pattern.length() - i);
+            if(lcp != 0){
+                std::uint64_t bp_pos = this->rich_bp.level_anc(2 * node - depth, lcp);
+                node = (bp_pos + depth - lcp) / 2;
+            }
+            i += lcp;
+            if(i == pattern.length()){
+                break;
             }
+            auto light_to = this->light_edges.find(node, pattern[i]);
+            if(light_to){
+                node = light_to.value();
+            }
+            else{
+                return std::nullopt;
+            }
+            ++i;
         }
-        assert(tps_order.size() == n);
-        std::vector<int> path_cnt(n, 0);
-        int sink = tps_order.back();
-        // assert(sink == base.node_ids.back());
-        path_cnt[sink] = 1;
-        std::vector<int> heavy_edge_to(n, -1);
-        std::vector<unsigned char> heavy_edge_label(n);
-        for(auto it = tps_order.rbegin(); it != tps_order.rend(); ++it){
-            int x = *it;
-            int path_cnt_max = 0;
-            for(auto [key, y] : base.nodes[x].ch.items()){
-                path_cnt[x] += path_cnt[y];
-                if(path_cnt_max < path_cnt[y]){
-                    path_cnt_max = path_cnt[y];
-                    heavy_edge_to[x] = y;
-                    heavy_edge_label[x] = key;
-                }
+        return node;
+    }
+    std::pair<std::uint64_t, int> longest_prefix(std::string_view pattern) const override{
+        std::uint64_t node = this->source;
+        unsigned int i = 0;
+        this->prefix_table.seek(pattern, node, i);
+        while(i < pattern.length()){
+            std::uint64_t pos = this->poses[node];
+            std::uint64_t depth = this->text.length() - pos;
+            int lcp = get_lcp(this->text_view, pos, pattern, i, pattern.length() - i);
+            if(lcp != 0){
+                std::uint64_t bp_pos = this->rich_bp.level_anc(2 * node - depth, lcp);
+                node = (bp_pos + depth - lcp) / 2;
             }
-            assert(1 <= path_cnt[x] && path_cnt[x] <= n);
+            i += lcp;
+            if(i == pattern.length()){
+                break;
+            }
+            auto light_to = this->light_edges.find(node, pattern[i]);
+            if(!light_to){
+                break;
+            }
+            node = light_to.value();
+            ++i;
+        }
+        return {i, static_cast<int>(node)};
+    }
+    std::uint64_t count(std::string_view pattern) const override{
+        auto node = get_node(pattern);
+        return node ? this->counts[node.value()] : 0;
+    }
+    void locate(std::string_view pattern, const std::function<void(std::uint64_t)>& callback) const override{
+        auto node = get_node(pattern);
+        if(node){
+            assert(this->occurrences);
+            this->occurrences->report(node.value(), this->counts[node.value()], pattern.length(), callback);
         }
+    }
+};
 
-        std::vector<std::vector<std::pair<unsigned char, int>>> heavy_tree(n);
-        for(int x = 0; x < n; ++x){
+
+// HeavyPathDAWG with hh_string stored by an alphabet policy (ByteAlphabet, DNAAlphabet).
+// Int is the type of node ids, std::int64_t for texts of 2^31 and more characters.
+template <template <typename, typename> typename MapType, typename Alphabet, typename Int = int> // requires std::is_base_of_v<Map, MapType>
+class BasicHeavyPathDAWG : public BasicFullTextIndex<Int> {
+    typename Alphabet::String hh_string;
+    LightEdgeStorage<MapType, Int> light_edges;
+    PackedVector counts;
+    std::optional<LocateTable> occurrences;
+    SuffixLinks suffix_links;
+    Int source;
+    BasicPrefixTable<Int> prefix_table;
+public:
+    // locate: also build the LocateTable, without which locate() and occurrence() are unavailable
+    explicit BasicHeavyPathDAWG(std::string_view text, bool locate = false) : BasicHeavyPathDAWG(text, build_heavy_paths<Int>(text, locate)) {}
+    // with the LocateTable iff the builder was built with locate
+    BasicHeavyPathDAWG(std::string_view text, const BasicHeavyPathBuilder<Int>& builder){
+        Int n = builder.n;
+        Int sink = builder.sink;
+        const auto& heavy_edge_to = builder.heavy_edge_to;
+        const auto& heavy_edge_label = builder.heavy_edge_label;
+        std::vector<Int> tps_order(n);
+        std::vector<Int> path_cnt(n, 0);
+        std::queue<Int> que;
+        Int cnt = 0;
+
+        std::vector<std::vector<std::pair<unsigned char, Int>>> heavy_tree(n);
+        for(Int x = 0; x < n; ++x){
             if(x != sink){
                 heavy_tree[heavy_edge_to[x]].emplace_back(heavy_edge_label[x], x);
             }
@@ -476,7 +1009,7 @@ public:
         cnt = 0;
         que.emplace(sink);
         while(!que.empty()){
-            int x = que.front();
+            Int x = que.front();
             tps_order[cnt] = x;
             ++cnt;
             que.pop();
@@ -486,17 +1019,17 @@ public:
         }
         path_cnt.assign(n, 0);
         // root (source) direction
-        std::vector<int> hh_edge_source(n, -1);
+        std::vector<Int> hh_edge_source(n, -1);
         // leaf (sink) direction
-        std::vector<int> hh_edge_sink(n, -1);
+        std::vector<Int> hh_edge_sink(n, -1);
         std::vector<unsigned char> hh_edge_label(n);
         for(auto it = tps_order.rbegin(); it != tps_order.rend(); ++it){
-            int x = *it;
+            Int x = *it;
             if(heavy_tree[x].empty()){
                 path_cnt[x] = 1;
             }
             else{
-                int path_cnt_max = 0;
+                Int path_cnt_max = 0;
                 for(auto [key, y] : heavy_tree[x]){
                     if(path_cnt_max < path_cnt[y]){
                         path_cnt_max = path_cnt[y];
@@ -508,45 +1041,47 @@ public:
                 hh_edge_sink[hh_edge_source[x]] = x;
             }
         }
-        std::vector<int> path_nodes(n);
-        std::vector<int> path_nodes_inv(n);
-        hh_string.resize(n, '\0');
+        std::vector<Int> path_nodes(n);
+        std::vector<Int> path_nodes_inv(n);
+        std::string hh_string_(n, '\0');
         cnt = 0;
-        for(int i = 0; i < n; ++i){
+        for(Int i = 0; i < n; ++i){
             if(hh_edge_source[i] == -1){
                 // heavy path start
-                std::vector<int> path;
-                for(int x = i; x != -1; x = hh_edge_sink[x]){
+                std::vector<Int> path;
+                for(Int x = i; x != -1; x = hh_edge_sink[x]){
                     path_nodes[cnt] = x;
                     path_nodes_inv[x] = cnt;
                     if(hh_edge_sink[x] != -1){
-                        hh_string[cnt] = hh_edge_label[x];
+                        hh_string_[cnt] = hh_edge_label[x];
                     }
                     ++cnt;
                 }
             }
         }
         assert(cnt == n);
-        std::vector<MapType<unsigned char, int>> light_edges_;
-        int edge_cnt = 0;
-        int hh_edge_cnt = 0;
-        for(int i = 0; i < n; ++i){
-            int x = path_nodes[i];
-            std::vector<unsigned char> keys;
-            std::vector<int> values;
-            for(auto [key, y] : base.nodes[x].ch.items()){
-                ++edge_cnt;
-                hh_edge_cnt += (key == hh_string[i]);
-                if(key != hh_string[i]){
-                    keys.emplace_back(key);
-                    values.emplace_back(path_nodes_inv[y]);
-                }
+        hh_string = typename Alphabet::String(hh_string_);
+        source = path_nodes_inv[0];
+        std::vector<Int> counts_(n);
+        for(Int i = 0; i < n; ++i){
+            counts_[i] = builder.occ[path_nodes[i]];
+        }
+        counts = PackedVector(counts_);
+        if(!builder.locate_lo.empty()){
+            std::vector<Int> lo(n);
+            for(Int i = 0; i < n; ++i){
+                lo[i] = builder.locate_lo[path_nodes[i]];
             }
-            light_edges_.emplace_back(keys, values);
+            occurrences.emplace(lo, builder.locate_positions);
         }
-        source = path_nodes_inv[0];
-        light_edges = light_edges_;
-        int heavy_edge_cnt = n - 1;
+        suffix_links = SuffixLinks(n, path_nodes, builder.slink, builder.len, [&](Int y){ return path_nodes_inv[y]; });
+        light_edges = LightEdgeStorage<MapType, Int>(n, [&](Int i, auto& keys, auto& values){
+            Int x = path_nodes[i];
+            builder.edges_except(x, hh_edge_sink[x], keys, values, [&](Int y){ return path_nodes_inv[y]; });
+        });
+        Int edge_cnt = builder.num_edges();
+        Int hh_edge_cnt = n - std::count(hh_edge_sink.begin(), hh_edge_sink.end(), -1);
+        Int heavy_edge_cnt = n - 1;
         std::clog << "n   : " << text.size() << std::endl;
         std::clog << "|V| : " << n << std::endl;
         std::clog << "|E| : " << edge_cnt << std::endl;
@@ -556,16 +1091,21 @@ public:
         std::clog << "|L| : " << edge_cnt - heavy_edge_cnt << std::endl;
         std::clog << std::endl;
     }
-    std::optional<int> get_node(std::string_view pattern) const override{
-        unsigned int node = source;
-        for(unsigned int i = 0; i < pattern.length();){
-            int lcp = get_lcp(pattern, i, hh_string, node, pattern.length() - i);
+    std::optional<Int> get_node(std::string_view pattern) const override{
+        Int node = source;
+        unsigned int i = 0;
+        if(!prefix_table.seek(pattern, node, i)){
+            return std::nullopt;
+        }
+        std::uint64_t end = hh_match_end(pattern);
+        while(i < pattern.length()){
+            int lcp = hh_string.lcp(node, pattern, i, end - i);
             node += lcp;
             i += lcp;
             if(i == pattern.length()){
                 break;
             }
-            auto light_to = light_edges[node].find(pattern[i]);
+            auto light_to = light_edges.find(node, pattern[i]);
             if(light_to){
                 node = light_to.value();
             }
@@ -576,16 +1116,187 @@ public:
         }
         return node;
     }
+    std::pair<std::uint64_t, Int> longest_prefix(std::string_view pattern) const override{
+        Int node = source;
+        unsigned int i = 0;
+        prefix_table.seek(pattern, node, i);
+        std::uint64_t end = hh_match_end(pattern);
+        while(i < pattern.length()){
+            int lcp = hh_string.lcp(node, pattern, i, end - i);
+            node += lcp;
+            i += lcp;
+            if(i == pattern.length()){
+                break;
+            }
+            auto light_to = light_edges.find(node, pattern[i]);
+            if(!light_to){
+                break;
+            }
+            node = light_to.value();
+            ++i;
+        }
+        return {i, node};
+    }
+    std::vector<std::optional<Int>> get_nodes(std::span<const std::string_view> patterns) const override{
+        // Extend: hh_string[node..] -> MapHeader: light_edges[node] -> Light: the map's items
+        enum Stage { Extend, MapHeader, Light };
+        struct State {
+            std::string_view pattern;
+            std::uint64_t end;
+            Int node;
+            unsigned int i;
+            Stage stage;
+            std::optional<Int> result;
+        };
+        return interleave<State>(patterns, [&](std::string_view pattern){
+            __builtin_prefetch(pattern.data());
+            return State{pattern, hh_match_end(pattern), source, 0, Extend, std::nullopt};
+        }, [&](State& s){
+            switch(s.stage){
+                case Extend: {
+                    int lcp = hh_string.lcp(s.node, s.pattern, s.i, s.end - s.i);
+                    s.node += lcp;
+                    s.i += lcp;
+                    if(s.i == s.pattern.length()){
+                        s.result = s.node;
+                        return true;
+                    }
+                    light_edges.prefetch_header(s.node);
+                    s.stage = MapHeader;
+                    return false;
+                }
+                case MapHeader:
+                    light_edges.prefetch(s.node);
+                    s.stage = Light;
+                    return false;
+                case Light: {
+                    auto light_to = light_edges.find(s.node, s.pattern[s.i]);
+                    if(!light_to){
+                        return true;
+                    }
+                    s.node = light_to.value();
+                    ++s.i;
+                    if(s.i == s.pattern.length()){
+                        s.result = s.node;
+                        return true;
+                    }
+                    hh_string.prefetch(s.node);
+                    __builtin_prefetch(s.pattern.data() + s.i);
+                    s.stage = Extend;
+                    return false;
+                }
+            }
+            return true;
+        });
+    }
+    // callback(i, l): l is the length of the longest suffix of query[0..i] that occurs in the text.
+    // One left-to-right pass: LCP jumps along hh_string extend the match, suffix links shorten it.
+    // The jumps stop at a '\0' of the query, which then mismatches and is reported with length 0.
+    void matching_statistics(std::string_view query, const std::function<void(std::uint64_t, std::uint64_t)>& callback) const{
+        Int node = source;
+        std::uint64_t length = 0;
+        std::uint64_t end = hh_match_end(query);
+        for(std::uint64_t i = 0; i < query.length();){
+            if(i > end){
+                end = hh_match_end(query, i);
+            }
+            int lcp = hh_string.lcp(node, query, i, end - i);
+            node += lcp;
+            for(int k = 0; k < lcp; ++k){
+                callback(i + k, ++length);
+            }
+            i += lcp;
+            if(i == query.length()){
+                break;
+            }
+            auto light_to = light_edges.find(node, query[i]);
+            if(light_to){
+                node = light_to.value();
+                callback(i, ++length);
+                ++i;
+            }
+            else if(node == source){
+                callback(i, 0);
+                ++i;
+            }
+            else{
+                length = suffix_links.length(node);
+                node = suffix_links.target(node);
+            }
+        }
+    }
+    void save(const std::string& path) const{
+        static_assert(std::is_same_v<Alphabet, ByteAlphabet>, "images store hh_string as bytes");
+        static_assert(sizeof(Int) == 4, "images store 32-bit node ids");
+        image::Writer writer(image::Kind::HeavyPath, 0, hh_string.size(), source);
+        FlatLightEdges flat(light_edges);
+        writer.add(image::Section::HHString, std::span(hh_string.bytes()));
+        auto counts_image = counts.image();
+        writer.add(image::Section::Counts, std::span(counts_image));
+        std::vector<std::uint64_t> lo_image, positions_image;
+        if(occurrences){
+            lo_image = occurrences->lo_array().image();
+            positions_image = occurrences->positions_array().image();
+            writer.add(image::Section::LocateLo, std::span(lo_image));
+            writer.add(image::Section::LocatePositions, std::span(positions_image));
+        }
+        flat.add_to(writer);
+        writer.write(path);
+    }
+    std::uint64_t count(std::string_view pattern) const override{
+        auto node = get_node(pattern);
+        return node ? counts[node.value()] : 0;
+    }
+    void locate(std::string_view pattern, const std::function<void(std::uint64_t)>& callback) const override{
+        auto node = get_node(pattern);
+        if(node){
+            assert(occurrences);
+            occurrences->report(node.value(), counts[node.value()], pattern.length(), callback);
+        }
+    }
+    // start of one occurrence of the length-`length` string of `node`, e.g. a node from longest_prefix
+    std::uint64_t occurrence(Int node, std::uint64_t length) const{
+        assert(occurrences);
+        return occurrences->first(node, length);
+    }
     virtual std::uint64_t num_bytes() const{
         std::uint64_t size = 0;
         size += sizeof(source);
-        size += hh_string.capacity() * sizeof(unsigned char) + 2 * sizeof(std::uint64_t);
-        size += decltype(light_edges)::offset_bytes;
-        for(int i = 0; i < light_edges.size(); ++i){
-            size += light_edges[i].num_bytes();
-        }
+        size += hh_string.num_bytes();
+        size += light_edges.num_bytes();
+        size += counts.num_bytes();
+        size += occurrences ? occurrences->num_bytes() : 0;
+        size += suffix_links.num_bytes();
+        size += prefix_table.num_bytes();
         return size;
     }
+    // optional table of the nodes of all occurring strings of length <= k (1..4), used by get_node and longest_prefix
+    void build_prefix_table(unsigned int k){
+        // the text has no '\0', which get_node would match against the ends of the heavy paths
+        prefix_table = BasicPrefixTable<Int>(k, [&](std::string_view prefix){
+            return prefix.find('\0') == std::string_view::npos ? get_node(prefix) : std::nullopt;
+        });
+    }
+};
+
+template <template <typename, typename> typename MapType>
+class HeavyPathDAWG : public BasicHeavyPathDAWG<MapType, ByteAlphabet> {
+public:
+    using BasicHeavyPathDAWG<MapType, ByteAlphabet>::BasicHeavyPathDAWG;
+};
+
+// text over A, C, G, T (plus rare other bytes), hh_string in 2 bits per symbol
+template <template <typename, typename> typename MapType>
+class DNAHeavyPathDAWG : public BasicHeavyPathDAWG<MapType, DNAAlphabet> {
+public:
+    using BasicHeavyPathDAWG<MapType, DNAAlphabet>::BasicHeavyPathDAWG;
+};
+
+// 64-bit node ids, for texts of 2^31 and more characters
+template <template <typename, typename> typename MapType>
+class HeavyPathDAWG64 : public BasicHeavyPathDAWG<MapType, ByteAlphabet, std::int64_t> {
+public:
+    using BasicHeavyPathDAWG<MapType, ByteAlphabet, std::int64_t>::BasicHeavyPathDAWG;
 };
 
 #endif //HEAVY_TREE_DAWG_DAWG_HPP
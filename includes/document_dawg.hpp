@@ -0,0 +1,273 @@
+#ifndef PACKED_DAWG_DOCUMENT_DAWG_HPP
+#define PACKED_DAWG_DOCUMENT_DAWG_HPP
+
+#include <bit>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <optional>
+#include <functional>
+#include <string_view>
+
+#include "full_text_index.hpp"
+#include "dawg.hpp"
+
+// Position of a minimum over any range of a packed array: the minimum of each block of 64 values,
+// a sparse table over the blocks, and a scan of the partial blocks at both ends.
+class RangeMinimum{
+    static constexpr std::uint64_t block = 64;
+    PackedVector values;
+    // table[j][b]: position of the minimum of blocks b .. b + 2^j - 1
+    std::vector<PackedVector> table;
+
+    std::uint64_t min_of(std::uint64_t i, std::uint64_t j) const{
+        return values[j] < values[i] ? j : i;
+    }
+    std::uint64_t scan(std::uint64_t l, std::uint64_t r) const{
+        std::uint64_t res = l;
+        for(std::uint64_t i = l + 1; i < r; ++i){
+            res = min_of(res, i);
+        }
+        return res;
+    }
+public:
+    RangeMinimum() = default;
+    explicit RangeMinimum(const std::vector<int>& values_) : values(values_){
+        std::uint64_t num_blocks = (values_.size() + block - 1) / block;
+        std::vector<std::uint64_t> level(num_blocks);
+        for(std::uint64_t b = 0; b < num_blocks; ++b){
+            level[b] = scan(b * block, std::min<std::uint64_t>(values_.size(), (b + 1) * block));
+        }
+        for(std::uint64_t width = 1; width <= num_blocks; width *= 2){
+            table.emplace_back(level);
+            std::vector<std::uint64_t> next(num_blocks - std::min(num_blocks, 2 * width - 1));
+            for(std::uint64_t b = 0; b < next.size(); ++b){
+                next[b] = min_of(level[b], level[b + width]);
+            }
+            level = std::move(next);
+        }
+    }
+    std::uint64_t operator[](std::uint64_t i) const{
+        return values[i];
+    }
+    // a position of the minimum of values[l .. r), l < r
+    std::uint64_t argmin(std::uint64_t l, std::uint64_t r) const{
+        assert(l < r);
+        std::uint64_t first = l / block + 1, last = (r - 1) / block;
+        if(first >= last){
+            return scan(l, r);
+        }
+        std::uint64_t res = min_of(scan(l, first * block), scan(last * block, r));
+        unsigned int j = std::bit_width(last - first) - 1;
+        res = min_of(res, table[j][first]);
+        return min_of(res, table[j][last - (std::uint64_t(1) << j)]);
+    }
+    std::uint64_t num_bytes() const{
+        std::uint64_t size = values.num_bytes() + 3 * sizeof(std::size_t);
+        for(const auto& level : table){
+            size += level.num_bytes();
+        }
+        return size;
+    }
+};
+
+// Generalised DAWG of a document collection, built with DAWGBase::extend so that no transition spans two
+// documents and patterns never match across a boundary.
+// Positions are offsets in the documents joined by one separator byte each (the collection itself when it is
+// given with its separator). Each node precomputes its number of documents (document_count in O(m)).
+// document_listing is output-sensitive (Muthukrishnan): the occurrences of a node are a range of the
+// suffix-link-tree preorder; prev[k] - 1 is the last earlier entry of the same document, so the entries of the
+// range whose prev points before it are exactly one per document, found by repeated range minima.
+template <template <typename, typename> typename MapType>
+class DocumentDAWG : public FullTextIndex {
+    LightEdgeStorage<MapType> edges;
+    PackedVector counts;
+    PackedVector document_counts;
+    LocateTable occurrences;
+    // per occurrence, in the order of occurrences
+    PackedVector documents;
+    RangeMinimum prev;
+    std::uint64_t num_documents_;
+
+    static std::vector<std::string_view> split(std::string_view collection, char separator){
+        std::vector<std::string_view> docs;
+        while(!collection.empty()){
+            auto end = collection.find(separator);
+            docs.emplace_back(collection.substr(0, end));
+            if(end == std::string_view::npos){
+                break;
+            }
+            collection.remove_prefix(end + 1);
+        }
+        return docs;
+    }
+
+public:
+    explicit DocumentDAWG(const std::vector<std::string_view>& docs) : num_documents_(docs.size()){
+        DAWGBase base;
+        // the node of each document prefix, and where that prefix ends in the joined collection
+        std::vector<int> prefix_nodes, prefix_ends, prefix_docs;
+        std::uint64_t offset = 0;
+        for(std::uint64_t d = 0; d < docs.size(); ++d){
+            int last = 0;
+            for(std::uint64_t j = 0; j < docs[d].size(); ++j){
+                last = base.extend(last, docs[d][j]);
+                prefix_nodes.emplace_back(last);
+                prefix_ends.emplace_back(offset + j + 1);
+                prefix_docs.emplace_back(d);
+            }
+            offset += docs[d].size() + 1;
+        }
+        int n = base.nodes.size();
+
+        // suffix-link tree and each node's own prefixes, both as CSR
+        std::vector<int> child_offsets(n + 1, 0), own_offsets(n + 1, 0);
+        for(int x = 1; x < n; ++x){
+            ++child_offsets[base.nodes[x].slink + 1];
+        }
+        for(int x : prefix_nodes){
+            ++own_offsets[x + 1];
+        }
+        for(int x = 0; x < n; ++x){
+            child_offsets[x + 1] += child_offsets[x];
+            own_offsets[x + 1] += own_offsets[x];
+        }
+        std::vector<int> children(n), own(prefix_nodes.size());
+        {
+            std::vector<int> filled(child_offsets.begin(), child_offsets.end() - 1);
+            for(int x = 1; x < n; ++x){
+                children[filled[base.nodes[x].slink]++] = x;
+            }
+            filled.assign(own_offsets.begin(), own_offsets.end() - 1);
+            for(std::uint64_t e = 0; e < prefix_nodes.size(); ++e){
+                own[filled[prefix_nodes[e]]++] = e;
+            }
+        }
+
+        // occurrences in preorder; counts[x] = size of x's range
+        std::vector<int> lo(n), counts_(n), positions, documents_;
+        positions.reserve(prefix_nodes.size());
+        documents_.reserve(prefix_nodes.size());
+        std::vector<std::pair<int, bool>> stack = {{0, false}};
+        while(!stack.empty()){
+            auto [x, done] = stack.back();
+            stack.pop_back();
+            if(done){
+                counts_[x] = positions.size() - lo[x];
+                continue;
+            }
+            lo[x] = positions.size();
+            for(int k = own_offsets[x]; k < own_offsets[x + 1]; ++k){
+                positions.emplace_back(prefix_ends[own[k]]);
+                documents_.emplace_back(prefix_docs[own[k]]);
+            }
+            stack.emplace_back(x, true);
+            for(int k = child_offsets[x]; k < child_offsets[x + 1]; ++k){
+                stack.emplace_back(children[k], false);
+            }
+        }
+
+        // distinct documents per node: each document marks the suffix-link paths of its prefixes once
+        std::vector<int> document_counts_(n, 0), mark(n, -1);
+        for(std::uint64_t e = 0; e < prefix_nodes.size(); ++e){
+            int d = prefix_docs[e];
+            for(int x = prefix_nodes[e]; x != -1 && mark[x] != d; x = base.nodes[x].slink){
+                mark[x] = d;
+                ++document_counts_[x];
+            }
+        }
+        document_counts_[0] = docs.size();
+
+        std::vector<int> prev_(documents_.size()), last_seen(docs.size(), 0);
+        for(std::uint64_t k = 0; k < documents_.size(); ++k){
+            prev_[k] = last_seen[documents_[k]];
+            last_seen[documents_[k]] = k + 1;
+        }
+
+        counts = PackedVector(counts_);
+        document_counts = PackedVector(document_counts_);
+        occurrences = LocateTable(lo, positions);
+        documents = PackedVector(documents_);
+        prev = RangeMinimum(prev_);
+        edges = LightEdgeStorage<MapType>(n, [&](int x, auto& keys, auto& values){
+            for(auto [key, y] : base.items(x)){
+                keys.emplace_back(key);
+                values.emplace_back(y);
+            }
+        });
+    }
+    // documents separated by `separator`; a trailing separator does not start another document
+    DocumentDAWG(std::string_view collection, char separator) : DocumentDAWG(split(collection, separator)) {}
+
+    std::uint64_t num_documents() const{
+        return num_documents_;
+    }
+    std::optional<int> get_node(std::string_view pattern) const override{
+        int node = 0;
+        for(char c : pattern){
+            auto next = edges.find(node, c);
+            if(!next){
+                return std::nullopt;
+            }
+            node = next.value();
+        }
+        return node;
+    }
+    std::uint64_t count(std::string_view pattern) const override{
+        auto node = get_node(pattern);
+        return node ? counts[node.value()] : 0;
+    }
+    void locate(std::string_view pattern, const std::function<void(std::uint64_t)>& callback) const override{
+        auto node = get_node(pattern);
+        if(node){
+            occurrences.report(node.value(), counts[node.value()], pattern.length(), callback);
+        }
+    }
+    // number of documents containing the pattern
+    std::uint64_t document_count(std::string_view pattern) const{
+        auto node = get_node(pattern);
+        return node ? document_counts[node.value()] : 0;
+    }
+    // callback(document) once for each document containing the pattern, in no particular order
+    void document_listing(std::string_view pattern, const std::function<void(std::uint64_t)>& callback) const{
+        auto node = get_node(pattern);
+        if(!node){
+            return;
+        }
+        if(pattern.empty()){
+            for(std::uint64_t d = 0; d < num_documents_; ++d){
+                callback(d);
+            }
+            return;
+        }
+        std::uint64_t l = occurrences.lo_array()[node.value()];
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> stack = {{l, l + counts[node.value()]}};
+        while(!stack.empty()){
+            auto [a, b] = stack.back();
+            stack.pop_back();
+            if(a >= b){
+                continue;
+            }
+            std::uint64_t k = prev.argmin(a, b);
+            if(prev[k] > l){
+                continue;
+            }
+            callback(documents[k]);
+            stack.emplace_back(a, k);
+            stack.emplace_back(k + 1, b);
+        }
+    }
+    std::uint64_t num_bytes() const override{
+        std::uint64_t size = sizeof(num_documents_);
+        size += edges.num_bytes();
+        size += counts.num_bytes();
+        size += document_counts.num_bytes();
+        size += occurrences.num_bytes();
+        size += documents.num_bytes();
+        size += prev.num_bytes();
+        return size;
+    }
+};
+
+#endif //PACKED_DAWG_DOCUMENT_DAWG_HPP
@@ -0,0 +1,519 @@
+#ifndef PACKED_DAWG_EXTERNAL_BUILDER_HPP
+#define PACKED_DAWG_EXTERNAL_BUILDER_HPP
+
+#include <bit>
+#include <queue>
+#include <limits>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <iostream>
+#include <optional>
+#include <algorithm>
+#include <unistd.h>
+
+#include "sdsl/construct.hpp"
+#include "sdsl/suffix_trees.hpp"
+
+#include "image.hpp"
+#include "packed_vector.hpp"
+
+// Semi-external construction of the image HeavyPathDAWG::save writes, for texts whose DAWGBase does not fit in memory.
+//
+// The DAWG of the text is the suffix tree of the reversed text R with its Weiner links as edges: the node with SA
+// interval [lb, rb] of R$ holds the reversals of the strings on its suffix tree edge, and its edge labelled c leads to
+// the node with the interval of c + its path label, found by rank on the BWT. The count of a node is the size of its
+// interval, and an occurrence starting at SA[k] in R ends at n - SA[k] in the text, so SA[lb, rb] are its positions.
+// A leaf whose edge is the sentinel alone is no DAWG node: its string is that of its parent.
+//
+// sdsl builds the compressed suffix tree of R semi-externally and leaves SA and LCP on disk, where they are only read
+// sequentially. In memory are the suffix tree and bit-packed arrays over its nodes, at most two of bit_width(nodes)
+// bits at a time; the node records go through external sorts by len, decreasing for the path counts to the sink
+// (edge targets first) and increasing for the heavy tree (children first), and the sections are streamed into the
+// image in place.
+// ram_budget bounds the sort runs and the I/O buffers; the suffix tree and the node arrays come on top of it.
+namespace external {
+
+// fixed-size records written to a file through a buffer
+template<typename T>
+class RecordWriter{
+    std::ofstream file;
+    std::vector<T> buffer;
+public:
+    RecordWriter(const std::string& path, std::uint64_t buffer_bytes) : file(path, std::ios::binary | std::ios::trunc){
+        assert(file.is_open());
+        buffer.reserve(std::max<std::uint64_t>(1, buffer_bytes / sizeof(T)));
+    }
+    void push(const T& record){
+        buffer.push_back(record);
+        if(buffer.size() == buffer.capacity()){
+            flush();
+        }
+    }
+    void flush(){
+        file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(T)));
+        buffer.clear();
+        assert(file.good());
+    }
+};
+
+// records of a file written by RecordWriter, read back in order through a buffer
+template<typename T>
+class RecordReader{
+    std::ifstream file;
+    std::vector<T> buffer;
+    std::size_t pos = 0, end = 0;
+public:
+    RecordReader(const std::string& path, std::uint64_t buffer_bytes) : file(path, std::ios::binary),
+        buffer(std::max<std::uint64_t>(1, buffer_bytes / sizeof(T))){
+        assert(file.is_open());
+    }
+    bool next(T& record){
+        if(pos == end){
+            file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(T)));
+            end = file.gcount() / sizeof(T);
+            pos = 0;
+            if(end == 0){
+                return false;
+            }
+        }
+        record = buffer[pos++];
+        return true;
+    }
+};
+
+// Sorts more records than fit in memory: runs of `budget` bytes are sorted and spilled to files, which for_each
+// merges. Nothing touches the disk if all records fit in one run.
+template<typename T, typename Compare>
+class Sorter{
+    std::string prefix;
+    std::uint64_t budget;
+    std::vector<T> run;
+    std::vector<std::string> run_paths;
+    Compare less;
+
+    void spill(){
+        std::sort(run.begin(), run.end(), less);
+        run_paths.emplace_back(prefix + "." + std::to_string(run_paths.size()));
+        RecordWriter<T> writer(run_paths.back(), budget / 16);
+        for(auto& record : run){
+            writer.push(record);
+        }
+        writer.flush();
+        run.clear();
+    }
+public:
+    Sorter(std::string prefix, std::uint64_t budget) : prefix(std::move(prefix)), budget(budget){
+        run.reserve(std::max<std::uint64_t>(1, budget / sizeof(T)));
+    }
+    Sorter(const Sorter&) = delete;
+    Sorter& operator=(const Sorter&) = delete;
+    ~Sorter(){
+        for(auto& path : run_paths){
+            std::remove(path.c_str());
+        }
+    }
+    void push(const T& record){
+        if(run.size() == run.capacity()){
+            spill();
+        }
+        run.push_back(record);
+    }
+    // fn(record) in sorted order, once
+    template<typename Fn>
+    void for_each(Fn fn){
+        if(run_paths.empty()){
+            std::sort(run.begin(), run.end(), less);
+            for(auto& record : run){
+                fn(record);
+            }
+            std::vector<T>().swap(run);
+            return;
+        }
+        spill();
+        std::vector<T>().swap(run);
+        std::vector<RecordReader<T>> readers;
+        for(auto& path : run_paths){
+            readers.emplace_back(path, budget / run_paths.size());
+        }
+        // {record, run}, smallest record on top
+        auto greater = [&](const std::pair<T, std::size_t>& a, const std::pair<T, std::size_t>& b){
+            return less(b.first, a.first);
+        };
+        std::priority_queue<std::pair<T, std::size_t>, std::vector<std::pair<T, std::size_t>>, decltype(greater)> heads(greater);
+        for(std::size_t r = 0; r < readers.size(); ++r){
+            T record;
+            if(readers[r].next(record)){
+                heads.emplace(record, r);
+            }
+        }
+        while(!heads.empty()){
+            auto [record, r] = heads.top();
+            heads.pop();
+            fn(record);
+            if(readers[r].next(record)){
+                heads.emplace(record, r);
+            }
+        }
+    }
+};
+
+class HeavyPathBuilder{
+    using Cst = sdsl::cst_sct3<>;
+    using Symbol = Cst::csa_type::wavelet_tree_type::value_type;
+
+    // node ids: the leaves by rank in [0, n], then the inner nodes by Cst::id in [n + 1, cst.nodes())
+    struct NodeRecord{
+        std::uint32_t len, id, heavy_to;
+    };
+    struct ByLen{
+        bool operator()(const NodeRecord& a, const NodeRecord& b) const{
+            return a.len != b.len ? a.len < b.len : a.id < b.id;
+        }
+    };
+    struct ByLenDescending{
+        bool operator()(const NodeRecord& a, const NodeRecord& b) const{
+            return a.len != b.len ? a.len > b.len : a.id < b.id;
+        }
+    };
+
+    std::string tmp_prefix;
+    std::uint64_t ram_budget;
+    sdsl::cache_config config;
+    Cst cst;
+    std::uint64_t n = 0, num_ids = 0;
+    // the leaf of R$ itself, whose strings are the prefixes of the text: the sink
+    std::uint64_t sink = 0;
+    std::uint64_t num_nodes = 0, num_edges = 0;
+    // interval_symbols results
+    std::vector<Symbol> symbols;
+    std::vector<Cst::size_type> rank_lb, rank_rb;
+    std::vector<std::uint32_t> by_symbol;
+
+    // heavy-tree paths, each from a heavy-tree leaf (path_start) up while the heavy edge is the hh edge (hh_edge)
+    PackedVector heavy_to;
+    sdsl::bit_vector path_start, hh_edge;
+    PackedVector path_id;
+    std::uint64_t source = 0;
+
+    std::uint64_t buffer_bytes() const{
+        return std::max<std::uint64_t>(ram_budget / 16, 1 << 16);
+    }
+    std::string cache_file(const char* key) const{
+        return sdsl::cache_file_name(key, config);
+    }
+    // SA interval of node x
+    std::pair<std::uint64_t, std::uint64_t> interval(std::uint64_t x) const{
+        if(x <= n){
+            return {x, x};
+        }
+        auto v = cst.inv_id(x);
+        return {cst.lb(v), cst.rb(v)};
+    }
+    std::uint64_t inner_id(const Cst::node_type& v) const{
+        std::uint64_t x = cst.id(v);
+        assert(x > n);
+        return x;
+    }
+    // fn(label, target, target's lb, target's rb) for the edges out of the node with interval [lb, rb], by label
+    template<typename Fn>
+    void for_each_edge(std::uint64_t lb, std::uint64_t rb, Fn fn){
+        const auto& csa = cst.csa;
+        Cst::size_type k = 0;
+        csa.wavelet_tree.interval_symbols(lb, rb + 1, k, symbols, rank_lb, rank_rb);
+        by_symbol.resize(k);
+        std::iota(by_symbol.begin(), by_symbol.end(), 0);
+        std::sort(by_symbol.begin(), by_symbol.end(), [&](auto a, auto b){
+            return symbols[a] < symbols[b];
+        });
+        for(auto t : by_symbol){
+            unsigned char c = symbols[t];
+            if(c == 0){
+                // the sentinel precedes R$ itself
+                continue;
+            }
+            std::uint64_t base = csa.C[csa.char2comp[c]];
+            std::uint64_t l = base + rank_lb[t], r = base + rank_rb[t] - 1;
+            std::uint64_t y = l == r ? l : inner_id(cst.lca(cst.select_leaf(l + 1), cst.select_leaf(r + 1)));
+            fn(c, y, l, r);
+        }
+    }
+    // R into a file, the text read backwards in blocks
+    std::string reverse_text(const std::string& text_path){
+        std::ifstream in(text_path, std::ios::binary | std::ios::ate);
+        assert(in.is_open());
+        n = in.tellg();
+        std::string reversed_path = tmp_prefix + ".reversed";
+        std::ofstream out(reversed_path, std::ios::binary | std::ios::trunc);
+        std::string block(std::min<std::uint64_t>(n, buffer_bytes()), '\0');
+        for(std::uint64_t end = n; end > 0;){
+            std::uint64_t length = std::min<std::uint64_t>(end, block.size());
+            end -= length;
+            in.seekg(static_cast<std::streamoff>(end));
+            in.read(block.data(), static_cast<std::streamsize>(length));
+            std::reverse(block.begin(), block.begin() + length);
+            assert(std::find(block.begin(), block.begin() + length, '\0') == block.begin() + length);
+            out.write(block.data(), static_cast<std::streamsize>(length));
+        }
+        assert(out.good());
+        return reversed_path;
+    }
+
+    // every DAWG node by decreasing len, with its len and id
+    void collect_nodes(Sorter<NodeRecord, ByLenDescending>& by_len){
+        auto visit = [&](std::uint64_t x, std::uint64_t len){
+            ++num_nodes;
+            by_len.push({static_cast<std::uint32_t>(len), static_cast<std::uint32_t>(x), 0});
+        };
+        // leaf k spells R[SA[k], n) and the sentinel; its parent's depth is the larger LCP next to it
+        sdsl::int_vector_buffer<> sa(cache_file(sdsl::conf::KEY_SA), std::ios::in, buffer_bytes());
+        sdsl::int_vector_buffer<> lcp(cache_file(sdsl::conf::KEY_LCP), std::ios::in, buffer_bytes());
+        for(std::uint64_t k = 0; k <= n; ++k){
+            std::uint64_t len = n - sa[k];
+            if(len > std::max<std::uint64_t>(lcp[k], k < n ? lcp[k + 1] : 0)){
+                visit(k, len);
+            }
+        }
+        for(std::uint64_t x = n + 1; x < num_ids; ++x){
+            visit(x, cst.depth(cst.inv_id(x)));
+        }
+    }
+
+    // Heavy edge of every DAWG node as in BasicHeavyPathBuilder: to the target with the most paths to the sink, the
+    // smallest label on ties. Edge targets have larger len, so one pass by decreasing len sums their path counts.
+    // The records with the heavy edge go to the sort by increasing len, the targets stay in heavy_to.
+    void find_heavy_edges(Sorter<NodeRecord, ByLenDescending>& by_len_descending, Sorter<NodeRecord, ByLen>& by_len){
+        PackedVector path_cnt(num_ids, std::bit_width(num_ids));
+        heavy_to = PackedVector(num_ids, std::bit_width(num_ids));
+        by_len_descending.for_each([&](const NodeRecord& record){
+            std::uint64_t x = record.id, heavy = x, paths = 0, max_paths = 0;
+            if(x == sink){
+                paths = 1;
+            }
+            auto [lb, rb] = interval(x);
+            for_each_edge(lb, rb, [&](unsigned char, std::uint64_t y, std::uint64_t, std::uint64_t){
+                ++num_edges;
+                paths += path_cnt[y];
+                if(max_paths < path_cnt[y]){
+                    max_paths = path_cnt[y];
+                    heavy = y;
+                }
+            });
+            assert((heavy == x) == (x == sink) && 1 <= paths && paths <= num_nodes);
+            path_cnt.set(x, paths);
+            heavy_to.set(x, heavy);
+            by_len.push({record.len, record.id, static_cast<std::uint32_t>(heavy)});
+        });
+    }
+
+    // Heavy-path decomposition of the heavy tree (parent = heavy edge target, rooted at the sink) as in
+    // HeavyPathDAWG: each node continues the path of its child with the most leaves below.
+    // Children have smaller len than their parent, so one pass by increasing len sees every node after its children.
+    void decompose(Sorter<NodeRecord, ByLen>& by_len){
+        unsigned int width = std::bit_width(num_ids);
+        // leaves[x] = 0 for ids that are no DAWG node; best_child + 1
+        PackedVector leaves(num_ids, width), best_child(num_ids, width);
+        by_len.for_each([&](const NodeRecord& record){
+            std::uint64_t x = record.id, y = record.heavy_to;
+            if(leaves[x] == 0){
+                leaves.set(x, 1);
+            }
+            if(x == sink){
+                return;
+            }
+            leaves.set(y, leaves[y] + leaves[x]);
+            if(best_child[y] == 0 || leaves[best_child[y] - 1] < leaves[x]){
+                best_child.set(y, x + 1);
+            }
+        });
+        path_start = sdsl::bit_vector(num_ids, 0);
+        hh_edge = sdsl::bit_vector(num_ids, 0);
+        for(std::uint64_t x = 0; x < num_ids; ++x){
+            if(leaves[x] == 0){
+                continue;
+            }
+            if(best_child[x] == 0){
+                path_start[x] = true;
+            }
+            else{
+                hh_edge[best_child[x] - 1] = true;
+            }
+        }
+    }
+
+    // fn(x, whether x continues to heavy_to[x]) over the DAWG nodes in path order
+    template<typename Fn>
+    void for_each_in_path_order(Fn fn) const{
+        for(std::uint64_t x = 0; x < num_ids; ++x){
+            if(!path_start[x]){
+                continue;
+            }
+            for(std::uint64_t v = x; ; v = heavy_to[v]){
+                bool next = hh_edge[v];
+                fn(v, next);
+                if(!next){
+                    break;
+                }
+            }
+        }
+    }
+
+public:
+    // builds everything but the sections; tmp_dir keeps sdsl's files and the sort runs until the builder is destroyed
+    HeavyPathBuilder(const std::string& text_path, const std::string& tmp_dir, std::uint64_t ram_budget) :
+        tmp_prefix(tmp_dir + "/external." + std::to_string(::getpid())), ram_budget(ram_budget),
+        config(false, tmp_dir, "external." + std::to_string(::getpid())){
+        std::string reversed_path = reverse_text(text_path);
+        assert(n > 0 && 2 * (n + 1) < static_cast<std::uint64_t>(std::numeric_limits<int>::max()));
+        sdsl::construct(cst, reversed_path, config, 1);
+        std::remove(reversed_path.c_str());
+        num_ids = cst.nodes();
+        symbols.resize(cst.csa.wavelet_tree.sigma);
+        rank_lb.resize(cst.csa.wavelet_tree.sigma);
+        rank_rb.resize(cst.csa.wavelet_tree.sigma);
+        sink = cst.csa.isa[0];
+        std::clog << "suffix tree: " << sdsl::size_in_bytes(cst) / (1024.0 * 1024.0) << " [MiB], " << num_ids << " nodes" << std::endl;
+
+        // heavy_to waits on disk while the decomposition needs its two arrays
+        std::string heavy_to_path = tmp_prefix + ".heavy_to";
+        {
+            Sorter<NodeRecord, ByLen> by_len(tmp_prefix + ".by_len", ram_budget / 2);
+            {
+                Sorter<NodeRecord, ByLenDescending> by_len_descending(tmp_prefix + ".by_len_descending", ram_budget / 2);
+                collect_nodes(by_len_descending);
+                find_heavy_edges(by_len_descending, by_len);
+            }
+            {
+                RecordWriter<std::uint32_t> heavy_to_file(heavy_to_path, buffer_bytes());
+                for(std::uint64_t x = 0; x < num_ids; ++x){
+                    heavy_to_file.push(heavy_to[x]);
+                }
+                heavy_to_file.flush();
+            }
+            heavy_to = PackedVector();
+            decompose(by_len);
+        }
+        heavy_to = PackedVector(num_ids, std::bit_width(num_ids));
+        {
+            RecordReader<std::uint32_t> heavy_to_file(heavy_to_path, buffer_bytes());
+            std::uint32_t y;
+            for(std::uint64_t x = 0; heavy_to_file.next(y); ++x){
+                heavy_to.set(x, y);
+            }
+        }
+        std::remove(heavy_to_path.c_str());
+
+        path_id = PackedVector(num_ids, std::bit_width(num_nodes));
+        std::uint64_t k = 0;
+        for_each_in_path_order([&](std::uint64_t x, bool){
+            path_id.set(x, k++);
+        });
+        assert(k == num_nodes);
+        source = path_id[inner_id(cst.root())];
+        std::clog << "DAWG |V|: " << num_nodes << ", |E|: " << num_edges << std::endl;
+    }
+    HeavyPathBuilder(const HeavyPathBuilder&) = delete;
+    HeavyPathBuilder& operator=(const HeavyPathBuilder&) = delete;
+    ~HeavyPathBuilder(){
+        sdsl::util::delete_all_files(config.file_map);
+    }
+
+    // the image, every section streamed in place in one pass over the nodes in path order (and one over SA if locate)
+    void write(const std::string& image_path, bool locate){
+        std::uint64_t num_paths = 0;
+        for(std::uint64_t x = 0; x < num_ids; ++x){
+            num_paths += path_start[x];
+        }
+        std::uint64_t num_light_edges = num_edges - (num_nodes - num_paths);
+        assert(num_light_edges <= std::numeric_limits<std::uint32_t>::max());
+        unsigned int count_width = std::bit_width(n + 1), position_width = std::bit_width(n);
+        std::vector<std::pair<image::Section, std::uint64_t>> sizes = {
+            {image::Section::HHString, num_nodes},
+            {image::Section::Counts, PackedImageWriter::num_bytes(num_nodes, count_width)},
+            {image::Section::LightOffsets, sizeof(std::uint32_t) * (num_nodes + 1)},
+            {image::Section::LightLabels, num_light_edges},
+            {image::Section::LightTargets, sizeof(int) * num_light_edges},
+        };
+        if(locate){
+            sizes.emplace_back(image::Section::LocateLo, PackedImageWriter::num_bytes(num_nodes, position_width));
+            sizes.emplace_back(image::Section::LocatePositions, PackedImageWriter::num_bytes(n + 1, position_width));
+        }
+        image::StreamWriter writer(image_path, image::Kind::HeavyPath, 0, num_nodes, source, sizes);
+        {
+            auto hh_file = writer.open(image::Section::HHString);
+            auto counts_file = writer.open(image::Section::Counts);
+            auto offsets_file = writer.open(image::Section::LightOffsets);
+            auto labels_file = writer.open(image::Section::LightLabels);
+            auto targets_file = writer.open(image::Section::LightTargets);
+            PackedImageWriter counts(counts_file, num_nodes, count_width);
+            std::optional<std::ofstream> lo_file;
+            std::optional<PackedImageWriter> lo;
+            if(locate){
+                lo_file.emplace(writer.open(image::Section::LocateLo));
+                lo.emplace(*lo_file, num_nodes, position_width);
+            }
+            std::uint32_t offset = 0;
+            offsets_file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+            for_each_in_path_order([&](std::uint64_t x, bool next){
+                auto [lb, rb] = interval(x);
+                char hh = '\0';
+                for_each_edge(lb, rb, [&](unsigned char c, std::uint64_t y, std::uint64_t, std::uint64_t){
+                    if(next && y == heavy_to[x]){
+                        hh = static_cast<char>(c);
+                        return;
+                    }
+                    int target = static_cast<int>(path_id[y]);
+                    labels_file.put(static_cast<char>(c));
+                    targets_file.write(reinterpret_cast<const char*>(&target), sizeof(target));
+                    ++offset;
+                });
+                hh_file.put(hh);
+                counts.push(rb - lb + 1);
+                if(lo){
+                    lo->push(lb);
+                }
+                offsets_file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+            });
+            assert(offset == num_light_edges);
+            counts.finish();
+            if(lo){
+                lo->finish();
+                lo_file->flush();
+                assert(lo_file->good());
+            }
+            for(auto* file : {&hh_file, &counts_file, &offsets_file, &labels_file, &targets_file}){
+                file->flush();
+                assert(file->good());
+            }
+        }
+        if(!locate){
+            return;
+        }
+        auto positions_file = writer.open(image::Section::LocatePositions);
+        PackedImageWriter positions(positions_file, n + 1, position_width);
+        sdsl::int_vector_buffer<> sa(cache_file(sdsl::conf::KEY_SA), std::ios::in, buffer_bytes());
+        for(std::uint64_t k = 0; k <= n; ++k){
+            positions.push(n - sa[k]);
+        }
+        positions.finish();
+        positions_file.flush();
+        assert(positions_file.good());
+    }
+};
+
+}
+
+// Writes the image of HeavyPathDAWG for the text in text_path (no '\0', fewer than 2^30 characters as for the 32-bit
+// image) to image_path, for MappedHeavyPathDAWG, with temporary files in tmp_dir. Node ids differ from an
+// in-memory HeavyPathDAWG's, the answers do not. The locate sections are written only with locate, as by
+// HeavyPathDAWG(text, locate).save.
+inline void build_heavy_path_image(const std::string& text_path, const std::string& image_path, std::uint64_t ram_budget, const std::string& tmp_dir, bool locate = false){
+    external::HeavyPathBuilder builder(text_path, tmp_dir, ram_budget);
+    builder.write(image_path, locate);
+}
+
+#endif //PACKED_DAWG_EXTERNAL_BUILDER_HPP
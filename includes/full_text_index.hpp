@@ -5,13 +5,58 @@
 #ifndef HEAVY_TREE_DAWG_FULL_TEXT_INDEX_HPP
 #define HEAVY_TREE_DAWG_FULL_TEXT_INDEX_HPP
 
+#include <span>
+#include <functional>
 #include <vector>
 #include <string_view>
+#include <cstdint>
+#include <utility>
 #include <optional>
+#include <type_traits>
 
-class FullTextIndex {
-    virtual std::optional<int> get_node(std::string_view pattern) const = 0;
+// Int: the integer type of node ids (int, or std::int64_t for the indexes of texts of 2^31 and more characters)
+template<typename Int>
+class BasicFullTextIndex {
+public:
+    virtual std::optional<Int> get_node(std::string_view pattern) const = 0;
     virtual std::uint64_t num_bytes() const = 0;
+    // number of occurrences of the pattern in the text
+    virtual std::uint64_t count(std::string_view pattern) const = 0;
+    // callback(start position) for every occurrence of the pattern, streamed in no particular order
+    virtual void locate(std::string_view pattern, const std::function<void(std::uint64_t)>& callback) const = 0;
+    // {length, node} of the longest prefix of the pattern that occurs in the text, node as returned by get_node.
+    // Falls back to a binary search over get_node; the DAWG indexes compute it in one traversal.
+    virtual std::pair<std::uint64_t, Int> longest_prefix(std::string_view pattern) const{
+        std::uint64_t lo = 0, hi = pattern.length();
+        Int node = get_node(pattern.substr(0, 0)).value();
+        while(lo < hi){
+            std::uint64_t mid = (lo + hi + 1) / 2;
+            auto res = get_node(pattern.substr(0, mid));
+            if(res){
+                lo = mid;
+                node = res.value();
+            }
+            else{
+                hi = mid - 1;
+            }
+        }
+        return {lo, node};
+    }
+    // one result per pattern, same as get_node; indexes override this to overlap the cache misses of several queries
+    virtual std::vector<std::optional<Int>> get_nodes(std::span<const std::string_view> patterns) const{
+        std::vector<std::optional<Int>> results;
+        results.reserve(patterns.size());
+        for(auto pattern : patterns){
+            results.emplace_back(get_node(pattern));
+        }
+        return results;
+    }
 };
 
+using FullTextIndex = BasicFullTextIndex<int>;
+
+// an index with either width of node ids
+template<typename Index>
+constexpr bool is_full_text_index_v = std::is_base_of_v<BasicFullTextIndex<int>, Index> || std::is_base_of_v<BasicFullTextIndex<std::int64_t>, Index>;
+
 #endif //HEAVY_TREE_DAWG_FULL_TEXT_INDEX_HPP
@@ -0,0 +1,160 @@
+#ifndef PACKED_DAWG_HEAVY_PATH_BUILDER_HPP
+#define PACKED_DAWG_HEAVY_PATH_BUILDER_HPP
+
+#include <vector>
+#include <thread>
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+
+inline int num_build_threads(){
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// fn(i) for i in [begin, end), statically split over the cores
+template<typename Fn>
+void parallel_for(std::int64_t begin, std::int64_t end, Fn fn){
+    constexpr std::int64_t grain = 1 << 14;
+    std::int64_t num_threads = std::min<std::int64_t>(num_build_threads(), (end - begin + grain - 1) / grain);
+    if(num_threads <= 1){
+        for(std::int64_t i = begin; i < end; ++i){
+            fn(i);
+        }
+        return;
+    }
+    std::vector<std::thread> threads;
+    for(std::int64_t t = 0; t < num_threads; ++t){
+        threads.emplace_back([&, t]{
+            std::int64_t l = begin + (end - begin) * t / num_threads;
+            std::int64_t r = begin + (end - begin) * (t + 1) / num_threads;
+            for(std::int64_t i = l; i < r; ++i){
+                fn(i);
+            }
+        });
+    }
+    for(auto& thread : threads){
+        thread.join();
+    }
+}
+
+// Everything the heavy-path indexes share, computed once from a DAWGBase:
+// the transitions as a sorted CSR, a topological order, occurrence counts and positions, suffix links, path counts to the sink and the heavy edges.
+//
+// The topological order is DAWGBase::topological_order, a counting sort by len.
+// Those levels are only one or two nodes wide on a DAWG, so the path_cnt DP is a single sequential sweep
+// over the CSR; the per-node phases (CSR extraction, map materialisation) run in parallel.
+// Int is the type of node ids, text positions and counts, std::int64_t for texts of 2^31 and more characters.
+template<typename Int>
+struct BasicHeavyPathBuilder{
+    using Offset = std::make_unsigned_t<Int>;
+    Int n, sink;
+    std::vector<Offset> edge_offsets;
+    std::vector<unsigned char> edge_labels;
+    std::vector<Int> edge_targets;
+    std::vector<Int> tps_order;
+    std::vector<Int> path_cnt;
+    std::vector<Int> heavy_edge_to;
+    std::vector<unsigned char> heavy_edge_label;
+    // text position reached by following heavy edges, poses[sink] = |text|
+    std::vector<Int> poses;
+    // number of occurrences of the strings of each node
+    std::vector<Int> occ;
+    // DAWGBase::suffix_link_preorder, empty unless built with locate
+    std::vector<Int> locate_lo, locate_positions;
+    // suffix links and lens of the DAWG nodes
+    std::vector<Int> slink, len;
+
+    template<typename Base>
+    explicit BasicHeavyPathBuilder(const Base& base, bool locate = false) : n(base.nodes.size()), sink(base.final_node){
+        static_assert(std::is_same_v<typename Base::Int, Int>);
+        edge_offsets.assign(n + 1, 0);
+        for(Int x = 0; x < n; ++x){
+            edge_offsets[x + 1] = edge_offsets[x] + base.nodes[x].num_edges;
+        }
+        edge_labels.resize(edge_offsets[n]);
+        edge_targets.resize(edge_offsets[n]);
+        parallel_for(0, n, [&](Int x){
+            Offset k = edge_offsets[x];
+            for(auto [key, y] : base.items(x)){
+                edge_labels[k] = key;
+                edge_targets[k] = y;
+                ++k;
+            }
+        });
+
+        Int max_len = base.nodes[sink].len;
+        tps_order = base.topological_order();
+        assert(tps_order.front() == 0 && tps_order.back() == sink);
+        occ = base.occurrence_counts(tps_order);
+        if(locate){
+            base.suffix_link_preorder(locate_lo, locate_positions);
+        }
+        slink.resize(n);
+        len.resize(n);
+        for(Int x = 0; x < n; ++x){
+            slink[x] = base.nodes[x].slink;
+            len[x] = base.nodes[x].len;
+        }
+
+        path_cnt.assign(n, 0);
+        path_cnt[sink] = 1;
+        heavy_edge_to.assign(n, -1);
+        heavy_edge_label.assign(n, 0);
+        poses.assign(n, -1);
+        poses[sink] = max_len;
+        for(auto it = tps_order.rbegin(); it != tps_order.rend(); ++it){
+            Int x = *it;
+            Int path_cnt_max = 0;
+            for(Offset k = edge_offsets[x]; k < edge_offsets[x + 1]; ++k){
+                Int y = edge_targets[k];
+                path_cnt[x] += path_cnt[y];
+                if(path_cnt_max < path_cnt[y]){
+                    path_cnt_max = path_cnt[y];
+                    heavy_edge_to[x] = y;
+                    assert(poses[y] != -1);
+                    poses[x] = poses[y] - 1;
+                    heavy_edge_label[x] = edge_labels[k];
+                }
+            }
+            assert(1 <= path_cnt[x] && path_cnt[x] <= n);
+        }
+    }
+
+    Int num_edges() const{
+        return edge_labels.size();
+    }
+
+    // maps[i] = MapType(keys, values) with keys/values filled by make(i, keys, values), built in parallel
+    template <template <typename, typename> typename MapType, typename Make>
+    static std::vector<MapType<unsigned char, Int>> build_maps(Int count, Make make){
+        std::vector<MapType<unsigned char, Int>> maps(count);
+        parallel_for(0, count, [&](Int i){
+            std::vector<unsigned char> keys;
+            std::vector<Int> values;
+            make(i, keys, values);
+            maps[i] = MapType<unsigned char, Int>(keys, values);
+        });
+        return maps;
+    }
+
+    // edges of node x except the one to `skip`, targets renamed by rename(y)
+    template<typename Rename>
+    void edges_except(Int x, Int skip, std::vector<unsigned char>& keys, std::vector<Int>& values, Rename rename) const{
+        for(Offset k = edge_offsets[x]; k < edge_offsets[x + 1]; ++k){
+            if(edge_targets[k] != skip){
+                keys.emplace_back(edge_labels[k]);
+                values.emplace_back(rename(edge_targets[k]));
+            }
+        }
+    }
+    // light edges of node x (all but the heavy one)
+    template<typename Rename>
+    void light_edges_of(Int x, std::vector<unsigned char>& keys, std::vector<Int>& values, Rename rename) const{
+        edges_except(x, heavy_edge_to[x], keys, values, rename);
+    }
+};
+
+using HeavyPathBuilder = BasicHeavyPathBuilder<int>;
+
+#endif //PACKED_DAWG_HEAVY_PATH_BUILDER_HPP
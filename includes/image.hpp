@@ -0,0 +1,269 @@
+#ifndef PACKED_DAWG_IMAGE_HPP
+#define PACKED_DAWG_IMAGE_HPP
+
+#include <span>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// On-disk image of a static index.
+// layout: [Header][SectionEntry * num_sections][section data ...]
+// every section starts at a multiple of `alignment` and is followed by at least `padding` zero bytes,
+// so word-parallel reads (get_lcp) near the end of a section never leave the mapping.
+namespace image {
+
+constexpr char magic[8] = {'P', 'D', 'A', 'W', 'G', 'I', 'M', 'G'};
+constexpr std::uint32_t version = 3;
+constexpr std::uint64_t alignment = 64;
+constexpr std::uint64_t padding = 64;
+
+enum class Kind : std::uint32_t {
+    HeavyPath = 1,
+    HeavyTree = 2,
+};
+
+enum class Section : std::uint32_t {
+    Text = 1,           // char[text_length]  (HeavyTree)
+    HHString = 2,       // char[num_nodes]    (HeavyPath)
+    Poses = 3,          // int32[num_nodes]
+    HeavyEdgeTo = 4,    // int32[num_nodes]
+    LightOffsets = 5,   // uint32[num_nodes + 1]
+    LightLabels = 6,    // uint8[num_light_edges], sorted within a node
+    LightTargets = 7,   // int32[num_light_edges]
+    Counts = 8,         // PackedVector::image() of the occurrence count of each node
+    LocateLo = 9,       // PackedVector::image() of LocateTable's lo, only if the index has one
+    LocatePositions = 10, // PackedVector::image() of LocateTable's positions, only if the index has one
+};
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    Kind kind;
+    std::uint32_t num_sections;
+    std::uint32_t reserved;
+    std::uint64_t text_length;
+    std::uint64_t num_nodes;
+    std::int64_t source;
+};
+
+struct SectionEntry {
+    Section id;
+    std::uint32_t reserved;
+    std::uint64_t offset;
+    std::uint64_t bytes;
+};
+
+inline std::uint64_t align_up(std::uint64_t x){
+    return (x + alignment - 1) / alignment * alignment;
+}
+
+inline Header make_header(Kind kind, std::uint64_t text_length, std::uint64_t num_nodes, std::int64_t source){
+    Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.kind = kind;
+    header.text_length = text_length;
+    header.num_nodes = num_nodes;
+    header.source = source;
+    return header;
+}
+
+// whether path holds an image of this format version and kind, e.g. before reusing a cached image
+inline bool is_current(const std::string& path, Kind kind){
+    std::ifstream file(path, std::ios::binary);
+    Header header{};
+    if(!file.read(reinterpret_cast<char*>(&header), sizeof(Header))){
+        return false;
+    }
+    return std::memcmp(header.magic, magic, sizeof(magic)) == 0 && header.version == version && header.kind == kind;
+}
+
+// entries of sections of the given sizes, in this order, and the size of the whole file
+inline std::vector<SectionEntry> layout(const std::vector<std::pair<Section, std::uint64_t>>& sizes, std::uint64_t& file_size){
+    std::vector<SectionEntry> entries;
+    std::uint64_t offset = align_up(sizeof(Header) + sizeof(SectionEntry) * sizes.size());
+    for(auto [id, bytes] : sizes){
+        entries.push_back({id, 0, offset, bytes});
+        offset = align_up(offset + bytes + padding);
+    }
+    file_size = offset;
+    return entries;
+}
+
+class Writer {
+    struct Item {
+        Section id;
+        const void* data;
+        std::uint64_t bytes;
+    };
+    Header header;
+    std::vector<Item> items;
+public:
+    Writer(Kind kind, std::uint64_t text_length, std::uint64_t num_nodes, std::int64_t source) :
+        header(make_header(kind, text_length, num_nodes, source)){
+    }
+    // the referenced memory has to stay alive until write()
+    template<typename T>
+    void add(Section id, std::span<T> data){
+        items.push_back({id, data.data(), data.size_bytes()});
+    }
+    void write(const std::string& path){
+        header.num_sections = items.size();
+        std::vector<std::pair<Section, std::uint64_t>> sizes;
+        for(auto& item : items){
+            sizes.emplace_back(item.id, item.bytes);
+        }
+        std::uint64_t offset;
+        std::vector<SectionEntry> entries = layout(sizes, offset);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        assert(file.is_open());
+        std::uint64_t written = 0;
+        auto put = [&](const void* data, std::uint64_t bytes){
+            file.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+            written += bytes;
+        };
+        auto fill = [&](std::uint64_t until){
+            static constexpr char zeros[alignment] = {};
+            while(written < until){
+                put(zeros, std::min<std::uint64_t>(until - written, alignment));
+            }
+        };
+        put(&header, sizeof(Header));
+        put(entries.data(), sizeof(SectionEntry) * entries.size());
+        for(std::size_t i = 0; i < items.size(); ++i){
+            fill(entries[i].offset);
+            put(items[i].data, items[i].bytes);
+        }
+        fill(offset);
+        assert(file.good());
+    }
+};
+
+// For builders that produce the sections as streams instead of holding them in memory: the sizes are given up front,
+// the header and a zero-filled file are laid out, then each section is written in place through its own stream.
+class StreamWriter {
+    std::string path;
+    std::vector<SectionEntry> entries;
+public:
+    StreamWriter(const std::string& path, Kind kind, std::uint64_t text_length, std::uint64_t num_nodes, std::int64_t source,
+                 const std::vector<std::pair<Section, std::uint64_t>>& sizes) : path(path){
+        std::uint64_t file_size;
+        entries = layout(sizes, file_size);
+        Header header = make_header(kind, text_length, num_nodes, source);
+        header.num_sections = entries.size();
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            assert(file.is_open());
+            file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+            file.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(sizeof(SectionEntry) * entries.size()));
+            assert(file.good());
+        }
+        std::filesystem::resize_file(path, file_size);
+    }
+    // positioned at the start of section `id`; exactly the bytes given for it are to be written
+    std::ofstream open(Section id) const{
+        for(auto& entry : entries){
+            if(entry.id == id){
+                std::ofstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+                assert(file.is_open());
+                file.seekp(static_cast<std::streamoff>(entry.offset));
+                return file;
+            }
+        }
+        assert(false);
+        return {};
+    }
+};
+
+// read-only, shared mapping of an image file
+class MappedFile {
+    const char* ptr = nullptr;
+    std::uint64_t _size = 0;
+public:
+    explicit MappedFile(const std::string& path){
+        int fd = ::open(path.c_str(), O_RDONLY);
+        assert(fd != -1);
+        struct stat st{};
+        [[maybe_unused]] int res = ::fstat(fd, &st);
+        assert(res == 0);
+        _size = st.st_size;
+        void* p = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+        assert(p != MAP_FAILED);
+        ::close(fd);
+        ptr = static_cast<const char*>(p);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept : ptr(other.ptr), _size(other._size){
+        other.ptr = nullptr;
+        other._size = 0;
+    }
+    ~MappedFile(){
+        if(ptr != nullptr){
+            ::munmap(const_cast<char*>(ptr), _size);
+        }
+    }
+    const char* data() const{
+        return ptr;
+    }
+    std::uint64_t size() const{
+        return _size;
+    }
+};
+
+class Reader {
+    MappedFile file;
+    const Header* _header;
+    std::span<const SectionEntry> entries;
+public:
+    Reader(const std::string& path, Kind kind) : file(path){
+        assert(file.size() >= sizeof(Header));
+        _header = reinterpret_cast<const Header*>(file.data());
+        assert(std::memcmp(_header->magic, magic, sizeof(magic)) == 0);
+        assert(_header->version == version);
+        assert(_header->kind == kind);
+        entries = {reinterpret_cast<const SectionEntry*>(file.data() + sizeof(Header)), _header->num_sections};
+        for(auto& entry : entries){
+            assert(entry.offset % alignment == 0);
+            assert(entry.offset + entry.bytes + padding <= file.size());
+        }
+    }
+    const Header& header() const{
+        return *_header;
+    }
+    bool has(Section id) const{
+        for(auto& entry : entries){
+            if(entry.id == id){
+                return true;
+            }
+        }
+        return false;
+    }
+    template<typename T>
+    std::span<const T> get(Section id) const{
+        for(auto& entry : entries){
+            if(entry.id == id){
+                assert(entry.bytes % sizeof(T) == 0);
+                return {reinterpret_cast<const T*>(file.data() + entry.offset), entry.bytes / sizeof(T)};
+            }
+        }
+        assert(false);
+        return {};
+    }
+    std::uint64_t num_bytes() const{
+        return file.size();
+    }
+};
+
+}
+
+#endif //PACKED_DAWG_IMAGE_HPP
@@ -0,0 +1,148 @@
+#ifndef PACKED_DAWG_LCP_HPP
+#define PACKED_DAWG_LCP_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// Longest common prefix kernels: lcp(a, b, n) = first i < n with a[i] != b[i], or n.
+// None of them reads a[n..] or b[n..]: the SIMD loops stop at the last full vector
+// and the tail is either a masked load (AVX-512) or the scalar kernel.
+namespace lcp {
+
+enum class Kernel {
+    Scalar,
+    AVX2,
+    AVX512,
+};
+
+using Function = std::size_t (*)(const char*, const char*, std::size_t);
+
+// 8 bytes per step, then byte by byte
+inline std::size_t scalar(const char* a, const char* b, std::size_t n){
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        std::uint64_t x, y;
+        std::memcpy(&x, a + i, 8);
+        std::memcpy(&y, b + i, 8);
+        if(x != y){
+            return i + __builtin_ctzll(x ^ y) / 8;
+        }
+    }
+    while(i < n && a[i] == b[i]){
+        ++i;
+    }
+    return i;
+}
+
+#if defined(__x86_64__)
+// 32 bytes per step: cmpeq + movemask + tzcnt
+__attribute__((target("avx2,bmi")))
+inline std::size_t avx2(const char* a, const char* b, std::size_t n){
+    std::size_t i = 0;
+    for(; i + 32 <= n; i += 32){
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        auto ne = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+        if(ne != 0){
+            return i + _tzcnt_u32(ne);
+        }
+    }
+    return i + scalar(a + i, b + i, n - i);
+}
+
+// 64 bytes per step, the tail with a masked (fault-suppressing) load
+__attribute__((target("avx512f,avx512bw,bmi")))
+inline std::size_t avx512(const char* a, const char* b, std::size_t n){
+    std::size_t i = 0;
+    for(; i + 64 <= n; i += 64){
+        __m512i x = _mm512_loadu_si512(a + i);
+        __m512i y = _mm512_loadu_si512(b + i);
+        __mmask64 ne = _mm512_cmpneq_epi8_mask(x, y);
+        if(ne != 0){
+            return i + _tzcnt_u64(ne);
+        }
+    }
+    if(i < n){
+        __mmask64 mask = ~std::uint64_t(0) >> (64 - (n - i));
+        __m512i x = _mm512_maskz_loadu_epi8(mask, a + i);
+        __m512i y = _mm512_maskz_loadu_epi8(mask, b + i);
+        __mmask64 ne = _mm512_mask_cmpneq_epi8_mask(mask, x, y);
+        if(ne != 0){
+            return i + _tzcnt_u64(ne);
+        }
+    }
+    return n;
+}
+#endif
+
+inline bool supported(Kernel kernel){
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    switch(kernel){
+        case Kernel::Scalar:
+            return true;
+        case Kernel::AVX2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi");
+        case Kernel::AVX512:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("bmi");
+    }
+    return false;
+#else
+    return kernel == Kernel::Scalar;
+#endif
+}
+
+inline Function function_of(Kernel kernel){
+#if defined(__x86_64__)
+    switch(kernel){
+        case Kernel::AVX2:
+            return avx2;
+        case Kernel::AVX512:
+            return avx512;
+        default:
+            break;
+    }
+#endif
+    return scalar;
+}
+
+// the widest kernel the CPU supports
+inline Kernel best(){
+    for(auto kernel : {Kernel::AVX512, Kernel::AVX2}){
+        if(supported(kernel)){
+            return kernel;
+        }
+    }
+    return Kernel::Scalar;
+}
+
+inline std::string name(Kernel kernel){
+    switch(kernel){
+        case Kernel::AVX2:
+            return "AVX2";
+        case Kernel::AVX512:
+            return "AVX512";
+        default:
+            return "Scalar";
+    }
+}
+
+// the kernel used by get_lcp, chosen once at startup
+inline Kernel current_kernel = best();
+inline Function current = function_of(current_kernel);
+
+// for benchmarks; the kernel has to be supported()
+inline void select(Kernel kernel){
+    current_kernel = kernel;
+    current = function_of(kernel);
+}
+
+}
+
+#endif //PACKED_DAWG_LCP_HPP
@@ -0,0 +1,178 @@
+#ifndef PACKED_DAWG_LEVEL_ANCESTOR_HPP
+#define PACKED_DAWG_LEVEL_ANCESTOR_HPP
+
+#include <bit>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+
+#include "packed_vector.hpp"
+
+// Level ancestors by ladders and jump pointers (Bender and Farach-Colton, "The level ancestor problem simplified").
+// The tree is split into longest paths. The ladder of a path of h nodes is the path plus up to h nodes above it,
+// so a node of height at least 2^i can climb 2^i steps inside one ladder.
+// The leaf at the bottom of each path keeps jump pointers to its 2^i-th ancestors for i = 0, s, 2s, ...
+// (s = jump_stride). ancestor(v, k) is one ladder lookup when the k-th ancestor is on v's ladder; otherwise it
+// goes down to the leaf of v's path, jumps and finishes with at most s ladder climbs.
+// Space: at most 2n ladder entries, two values per node and (#leaves) * log(depth) / s jump pointers,
+// all bit-packed; a larger stride trades query time for space.
+class LevelAncestor{
+    unsigned int jump_stride = 1;
+    // ladders top-down, ladder L is ladder[ladder_begin[L] .. ladder_begin[L + 1])
+    PackedVector ladder;
+    PackedVector ladder_begin;
+    // where v is on its own path's ladder
+    PackedVector ladder_index;
+    PackedVector ladder_of;
+    // jump pointers of the leaf of ladder L: jumps[jump_begin[L] + t] is its 2^(t * jump_stride)-th ancestor
+    PackedVector jumps;
+    PackedVector jump_begin;
+
+    // the k-th ancestor if it is on the ladder of v, else -1 after moving v to the ladder top (k reduced accordingly)
+    int climb(int& v, std::uint64_t& k) const{
+        std::uint64_t index = ladder_index[v];
+        std::uint64_t begin = ladder_begin[ladder_of[v]];
+        if(k <= index - begin){
+            return ladder[index - k];
+        }
+        k -= index - begin;
+        v = ladder[begin];
+        return -1;
+    }
+
+public:
+    LevelAncestor() = default;
+    // parent[v] = -1 for roots
+    explicit LevelAncestor(const std::vector<int>& parent, unsigned int jump_stride = 1) : jump_stride(jump_stride){
+        assert(jump_stride >= 1);
+        int n = parent.size();
+        std::vector<int> child_offsets(n + 1, 0);
+        for(int v = 0; v < n; ++v){
+            if(parent[v] != -1){
+                ++child_offsets[parent[v] + 1];
+            }
+        }
+        for(int v = 0; v < n; ++v){
+            child_offsets[v + 1] += child_offsets[v];
+        }
+        std::vector<int> children(child_offsets[n]);
+        std::vector<int> filled(child_offsets.begin(), child_offsets.end() - 1);
+        for(int v = 0; v < n; ++v){
+            if(parent[v] != -1){
+                children[filled[parent[v]]++] = v;
+            }
+        }
+
+        // preorder, parents first
+        std::vector<int> order, depth(n, 0);
+        order.reserve(n);
+        std::vector<int> stack;
+        for(int v = 0; v < n; ++v){
+            if(parent[v] == -1){
+                stack.emplace_back(v);
+            }
+        }
+        while(!stack.empty()){
+            int v = stack.back();
+            stack.pop_back();
+            order.emplace_back(v);
+            for(int k = child_offsets[v]; k < child_offsets[v + 1]; ++k){
+                depth[children[k]] = depth[v] + 1;
+                stack.emplace_back(children[k]);
+            }
+        }
+        assert(order.size() == n);
+
+        std::vector<int> height(n, 0), long_child(n, -1);
+        for(auto it = order.rbegin(); it != order.rend(); ++it){
+            int v = *it;
+            if(parent[v] != -1 && height[parent[v]] < height[v] + 1){
+                height[parent[v]] = height[v] + 1;
+                long_child[parent[v]] = v;
+            }
+        }
+
+        // path tops in preorder, so ladders and their leaves come in preorder too
+        std::vector<int> ladder_, ladder_begin_, ladder_index_(n), ladder_of_(n), leaves;
+        std::vector<int> extension;
+        for(int top : order){
+            if(parent[top] != -1 && long_child[parent[top]] == top){
+                continue;
+            }
+            int id = ladder_begin_.size();
+            ladder_begin_.emplace_back(ladder_.size());
+            extension.clear();
+            for(int u = parent[top]; u != -1 && extension.size() < height[top] + 1; u = parent[u]){
+                extension.emplace_back(u);
+            }
+            ladder_.insert(ladder_.end(), extension.rbegin(), extension.rend());
+            int leaf = top;
+            for(int v = top; v != -1; v = long_child[v]){
+                ladder_index_[v] = ladder_.size();
+                ladder_of_[v] = id;
+                ladder_.emplace_back(v);
+                leaf = v;
+            }
+            leaves.emplace_back(leaf);
+        }
+        ladder_begin_.emplace_back(ladder_.size());
+
+        // jump pointers from the root path of each leaf, read off a preorder walk
+        std::vector<int> jumps_, jump_begin_(leaves.size() + 1, 0);
+        std::vector<int> leaf_ladder(n, -1);
+        for(int id = 0; id < leaves.size(); ++id){
+            leaf_ladder[leaves[id]] = id;
+        }
+        std::vector<std::vector<int>> leaf_jumps(leaves.size());
+        std::vector<int> root_path;
+        for(int v : order){
+            root_path.resize(depth[v]);
+            root_path.emplace_back(v);
+            if(leaf_ladder[v] != -1){
+                for(std::uint64_t i = 0; (std::uint64_t(1) << i) <= depth[v]; i += jump_stride){
+                    leaf_jumps[leaf_ladder[v]].emplace_back(root_path[depth[v] - (std::uint64_t(1) << i)]);
+                }
+            }
+        }
+        for(int id = 0; id < leaves.size(); ++id){
+            jumps_.insert(jumps_.end(), leaf_jumps[id].begin(), leaf_jumps[id].end());
+            jump_begin_[id + 1] = jumps_.size();
+        }
+
+        ladder = PackedVector(ladder_);
+        ladder_begin = PackedVector(ladder_begin_);
+        ladder_index = PackedVector(ladder_index_);
+        ladder_of = PackedVector(ladder_of_);
+        jumps = PackedVector(jumps_);
+        jump_begin = PackedVector(jump_begin_);
+    }
+
+    // the k-th ancestor of v, k <= depth(v)
+    int ancestor(int v, std::uint64_t k) const{
+        std::uint64_t index = ladder_index[v];
+        std::uint64_t id = ladder_of[v];
+        std::uint64_t begin = ladder_begin[id];
+        if(k <= index - begin){
+            return ladder[index - k];
+        }
+        // from the leaf of v's path, jump 2^i steps to a node of height >= 2^i, then climb ladders
+        k += ladder_begin[id + 1] - 1 - index;
+        unsigned int t = (std::bit_width(k) - 1) / jump_stride;
+        v = jumps[jump_begin[id] + t];
+        k -= std::uint64_t(1) << (t * jump_stride);
+        int res;
+        while((res = climb(v, k)) == -1);
+        return res;
+    }
+
+    std::uint64_t num_bytes() const{
+        std::uint64_t size = sizeof(jump_stride);
+        size += ladder.num_bytes() + ladder_begin.num_bytes();
+        size += ladder_index.num_bytes() + ladder_of.num_bytes();
+        size += jumps.num_bytes() + jump_begin.num_bytes();
+        return size;
+    }
+};
+
+#endif //PACKED_DAWG_LEVEL_ANCESTOR_HPP
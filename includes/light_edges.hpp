@@ -0,0 +1,121 @@
+#ifndef PACKED_DAWG_LIGHT_EDGES_HPP
+#define PACKED_DAWG_LIGHT_EDGES_HPP
+
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <optional>
+#include <algorithm>
+#include <type_traits>
+
+#include "map.hpp"
+#include "vector.hpp"
+#include "packed_vector.hpp"
+#include "heavy_path_builder.hpp"
+
+// MapType tag: store the light edges of all nodes as one CSR (LightEdgeStorage<CSRMap>)
+// instead of one map object per node
+template<typename K, typename V>
+struct CSRMap;
+
+// The light edges of every node of a static index, one MapType per node, node ids of type Int.
+// make(i, keys, values) fills the light edges of node i with keys in increasing order.
+template <template <typename, typename> typename MapType, typename Int = int>
+class LightEdgeStorage{
+    Vector<MapType<unsigned char, Int>, std::make_unsigned_t<Int>> maps;
+public:
+    LightEdgeStorage() = default;
+    template<typename Make>
+    LightEdgeStorage(Int count, Make make) : maps(BasicHeavyPathBuilder<Int>::template build_maps<MapType>(count, make)){}
+
+    std::optional<Int> find(std::uint64_t node, unsigned char key) const{
+        return maps[node].find(key);
+    }
+    // the two dependent loads of find(node, ·), for interleaved queries
+    void prefetch_header(std::uint64_t node) const{
+        __builtin_prefetch(&maps[node]);
+    }
+    void prefetch(std::uint64_t node) const{
+        maps[node].prefetch();
+    }
+    std::vector<std::pair<unsigned char, Int>> items(std::uint64_t node) const{
+        return maps[node].items();
+    }
+    std::uint64_t size() const{
+        return maps.size();
+    }
+    std::uint64_t num_bytes() const{
+        std::uint64_t size = maps.offset_bytes;
+        for(std::uint64_t i = 0; i < maps.size(); ++i){
+            size += maps[i].num_bytes();
+        }
+        return size;
+    }
+};
+
+// All light edges in one offsets / labels / targets layout: sizeof(Int) bytes per node plus one byte and a
+// bit-packed node id per edge, no per-node object or heap block. Labels are sorted within a node.
+template <typename Int>
+class LightEdgeStorage<CSRMap, Int>{
+    std::vector<std::make_unsigned_t<Int>> offsets;
+    std::vector<unsigned char> labels;
+    PackedVector targets;
+public:
+    LightEdgeStorage() : offsets(1, 0){}
+    template<typename Make>
+    LightEdgeStorage(Int count, Make make) : offsets(1, 0){
+        offsets.reserve(count + 1);
+        std::vector<unsigned char> keys;
+        std::vector<Int> values, targets_;
+        for(Int i = 0; i < count; ++i){
+            keys.clear();
+            values.clear();
+            make(i, keys, values);
+            assert(std::is_sorted(keys.begin(), keys.end()));
+            labels.insert(labels.end(), keys.begin(), keys.end());
+            targets_.insert(targets_.end(), values.begin(), values.end());
+            offsets.emplace_back(labels.size());
+        }
+        labels.shrink_to_fit();
+        targets = PackedVector(targets_);
+    }
+
+    std::optional<Int> find(std::uint64_t node, unsigned char key) const{
+        for(std::uint64_t k = offsets[node]; k < offsets[node + 1]; ++k){
+            if(labels[k] == key){
+                return targets[k];
+            }
+            else if(key < labels[k]){
+                break;
+            }
+        }
+        return std::nullopt;
+    }
+    void prefetch_header(std::uint64_t node) const{
+        __builtin_prefetch(&offsets[node]);
+    }
+    void prefetch(std::uint64_t node) const{
+        __builtin_prefetch(labels.data() + offsets[node]);
+        targets.prefetch(offsets[node]);
+    }
+    std::vector<std::pair<unsigned char, Int>> items(std::uint64_t node) const{
+        std::vector<std::pair<unsigned char, Int>> res;
+        for(std::uint64_t k = offsets[node]; k < offsets[node + 1]; ++k){
+            res.emplace_back(labels[k], targets[k]);
+        }
+        return res;
+    }
+    std::uint64_t size() const{
+        return offsets.size() - 1;
+    }
+    std::uint64_t num_bytes() const{
+        std::uint64_t size = 0;
+        size += offsets.capacity() * sizeof(std::make_unsigned_t<Int>) + 2 * sizeof(std::size_t);
+        size += labels.capacity() * sizeof(unsigned char) + 2 * sizeof(std::size_t);
+        size += targets.num_bytes();
+        return size;
+    }
+};
+
+#endif //PACKED_DAWG_LIGHT_EDGES_HPP
@@ -0,0 +1,50 @@
+#ifndef PACKED_DAWG_LOCATE_HPP
+#define PACKED_DAWG_LOCATE_HPP
+
+#include <vector>
+#include <cstdint>
+
+#include "packed_vector.hpp"
+
+// The occurrences of every node as one contiguous range of end positions.
+// positions lists the end position of every prefix of the text in suffix-link-tree preorder
+// (DAWGBase::suffix_link_preorder); node x owns positions[lo[x] .. lo[x] + count(x)).
+// Reporting is a sequential scan of that range, O(1) per occurrence.
+// Optional: the indexes build it only when constructed with locate = true, and cost nothing for it otherwise.
+class LocateTable{
+    PackedVector lo;
+    PackedVector positions;
+public:
+    LocateTable() = default;
+    // lo in the node order of the index
+    template<typename Int>
+    LocateTable(const std::vector<Int>& lo, const std::vector<Int>& positions) : lo(lo), positions(positions){}
+
+    // fn(start position) for each occurrence of a pattern of length `length` ending at the strings of `node`
+    template<typename Packed, typename Fn>
+    static void report(const Packed& lo, const Packed& positions, std::uint64_t node, std::uint64_t count, std::uint64_t length, Fn fn){
+        std::uint64_t begin = lo[node];
+        for(std::uint64_t k = begin; k < begin + count; ++k){
+            fn(positions[k] - length);
+        }
+    }
+    template<typename Fn>
+    void report(std::uint64_t node, std::uint64_t count, std::uint64_t length, Fn fn) const{
+        report(lo, positions, node, count, length, fn);
+    }
+    // start position of one occurrence of a pattern of length `length` ending at the strings of `node`
+    std::uint64_t first(std::uint64_t node, std::uint64_t length) const{
+        return positions[lo[node]] - length;
+    }
+    const PackedVector& lo_array() const{
+        return lo;
+    }
+    const PackedVector& positions_array() const{
+        return positions;
+    }
+    std::uint64_t num_bytes() const{
+        return lo.num_bytes() + positions.num_bytes();
+    }
+};
+
+#endif //PACKED_DAWG_LOCATE_HPP
@@ -6,6 +6,12 @@
 #include <cstdint>
 #include <numeric>
 #include <optional>
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 #include "vector.hpp"
 
 
@@ -46,6 +52,9 @@ struct DynamicHashMap : Map<T, U> {
         }
         return std::nullopt;
     }
+    void prefetch() const{
+        __builtin_prefetch(v.data());
+    }
 
     void add(T x, U val){
         assert(x != null);
@@ -131,8 +140,11 @@ struct HashMap : Map<T, U> {
         }
         return std::nullopt;
     }
+    void prefetch() const{
+        __builtin_prefetch(v.data());
+    }
 
-    std::vector<std::pair<T, U>> items(){
+    std::vector<std::pair<T, U>> items() const{
         std::vector<std::pair<T, U>> items;
         for(int i = 0; i < v.size(); ++i){
             auto& item = v[i];
@@ -177,7 +189,8 @@ private:
 
 template<typename K, typename V>
 struct BinarySearchMap : Map<K, V> {
-    Vector<std::pair<K, V>, std::uint8_t> items_;
+    // up to 256 items (all the edges of a SimpleDAWG node); the size sits in the padding of the pointer either way
+    Vector<std::pair<K, V>, std::uint16_t> items_;
     explicit BinarySearchMap(){}
     explicit BinarySearchMap(const std::map<K, V>& map){
         std::vector<std::pair<K, V>> items__;
@@ -225,6 +238,9 @@ struct BinarySearchMap : Map<K, V> {
         }
         return std::nullopt;
     }
+    void prefetch() const{
+        __builtin_prefetch(items_.data());
+    }
     std::vector<std::pair<K, V>> items() const{
         std::vector<std::pair<K, V>> items__(items_.size());
         for(int i = 0; i < items_.size(); ++i){
@@ -240,6 +256,101 @@ struct BinarySearchMap : Map<K, V> {
     }
 };
 
+#if defined(__x86_64__)
+namespace simd_map {
+// checked once; labels of nodes with more than 16 children are scanned 32 at a time
+inline const bool has_avx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi"));
+
+// slot of key in labels[0..size), or -1; labels[size..] has to be readable up to the next 32 bytes
+__attribute__((target("avx2,bmi")))
+inline int find_avx2(const unsigned char* labels, unsigned int size, unsigned char key){
+    __m256i needle = _mm256_set1_epi8(static_cast<char>(key));
+    for(unsigned int i = 0; i < size; i += 32){
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(labels + i));
+        std::uint32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+        if(size - i < 32){
+            mask &= (std::uint32_t(1) << (size - i)) - 1;
+        }
+        if(mask != 0){
+            return i + _tzcnt_u32(mask);
+        }
+    }
+    return -1;
+}
+}
+#endif
+
+// One heap block: [labels (n bytes)][targets (n * sizeof(V))], zero-padded to at least 16 bytes,
+// so a 16-byte load at the labels never leaves the block and the targets are on the same cache line.
+// find compares all labels against the key at once (SSE2 cmpeq + movemask + ctz, bytes past the labels
+// are masked out; AVX2 for nodes with more than 16 children when the CPU has it); other targets scan the labels.
+template<typename K, typename V>
+struct SIMDMap : Map<K, V> {
+    static_assert(sizeof(K) == 1);
+    std::uint8_t n;
+    Vector<unsigned char, std::uint16_t> bytes;
+
+    SIMDMap() : n(0){}
+    SIMDMap(const std::vector<K>& keys, const std::vector<V>& values) : n(keys.size()){
+        assert(keys.size() == values.size() && keys.size() <= 255);
+        if(!keys.empty()){
+            std::vector<unsigned char> bytes_(std::max<std::size_t>(16, n * (1 + sizeof(V))), 0);
+            std::memcpy(bytes_.data(), keys.data(), n);
+            std::memcpy(bytes_.data() + n, values.data(), n * sizeof(V));
+            bytes = bytes_;
+        }
+    }
+    V value(unsigned int slot) const{
+        V res;
+        std::memcpy(&res, bytes.data() + n + slot * sizeof(V), sizeof(V));
+        return res;
+    }
+    std::optional<V> find(const K key) const override{
+        unsigned int size = n;
+        const unsigned char* labels = bytes.data();
+#if defined(__x86_64__)
+        if(size > 16 && simd_map::has_avx2){
+            int slot = simd_map::find_avx2(labels, size, key);
+            return slot == -1 ? std::nullopt : std::optional<V>(value(slot));
+        }
+        __m128i needle = _mm_set1_epi8(static_cast<char>(key));
+        for(unsigned int i = 0; i < size; i += 16){
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(labels + i));
+            std::uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+            if(size - i < 16){
+                mask &= (std::uint32_t(1) << (size - i)) - 1;
+            }
+            if(mask != 0){
+                return value(i + __builtin_ctz(mask));
+            }
+        }
+#else
+        for(unsigned int i = 0; i < size; ++i){
+            if(labels[i] == static_cast<unsigned char>(key)){
+                return value(i);
+            }
+        }
+#endif
+        return std::nullopt;
+    }
+    void prefetch() const{
+        __builtin_prefetch(bytes.data());
+    }
+    std::vector<std::pair<K, V>> items() const{
+        std::vector<std::pair<K, V>> items__(n);
+        for(unsigned int i = 0; i < n; ++i){
+            items__[i] = {static_cast<K>(bytes[i]), value(i)};
+        }
+        return items__;
+    }
+    int size() const override{
+        return n;
+    }
+    std::uint64_t num_bytes() const override{
+        return sizeof(n) + bytes.num_bytes();
+    }
+};
+
 /*
 template <typename T, typename U>
 struct StdMapWrapper : Map<T, U>{
@@ -0,0 +1,213 @@
+#ifndef PACKED_DAWG_MAPPED_DAWG_HPP
+#define PACKED_DAWG_MAPPED_DAWG_HPP
+
+#include <span>
+#include <string>
+#include <optional>
+#include <algorithm>
+
+#include "full_text_index.hpp"
+#include "image.hpp"
+#include "dawg.hpp"
+#include "packed_vector.hpp"
+#include "locate.hpp"
+
+// a PackedVector section, empty if the image does not have it (the locate sections)
+inline PackedSpan optional_packed_section(const image::Reader& reader, image::Section id){
+    return reader.has(id) ? PackedSpan(reader.get<std::uint64_t>(id)) : PackedSpan();
+}
+
+// light edges read straight from the mapped pages
+struct MappedLightEdges {
+    std::span<const std::uint32_t> offsets;
+    std::span<const unsigned char> labels;
+    std::span<const int> targets;
+
+    explicit MappedLightEdges(const image::Reader& reader) :
+        offsets(reader.get<std::uint32_t>(image::Section::LightOffsets)),
+        labels(reader.get<unsigned char>(image::Section::LightLabels)),
+        targets(reader.get<int>(image::Section::LightTargets)){
+    }
+    std::optional<int> find(std::uint32_t node, unsigned char key) const{
+        auto first = labels.begin() + offsets[node];
+        auto last = labels.begin() + offsets[node + 1];
+        auto it = std::lower_bound(first, last, key);
+        if(it != last && *it == key){
+            return targets[it - labels.begin()];
+        }
+        return std::nullopt;
+    }
+};
+
+// HeavyPathDAWG saved by HeavyPathDAWG::save
+class MappedHeavyPathDAWG : public FullTextIndex {
+    image::Reader reader;
+    std::string_view hh_string;
+    MappedLightEdges light_edges;
+    PackedSpan counts;
+    PackedSpan locate_lo, locate_positions;
+    int source;
+public:
+    static constexpr image::Kind kind = image::Kind::HeavyPath;
+    explicit MappedHeavyPathDAWG(const std::string& path) :
+        reader(path, kind),
+        hh_string([this]{
+            auto hh = reader.get<char>(image::Section::HHString);
+            return std::string_view(hh.data(), hh.size());
+        }()),
+        light_edges(reader),
+        counts(reader.get<std::uint64_t>(image::Section::Counts)),
+        locate_lo(optional_packed_section(reader, image::Section::LocateLo)),
+        locate_positions(optional_packed_section(reader, image::Section::LocatePositions)),
+        source(reader.header().source){
+        assert(light_edges.offsets.size() == hh_string.size() + 1);
+    }
+    std::optional<int> get_node(std::string_view pattern) const override{
+        unsigned int node = source;
+        std::uint64_t end = hh_match_end(pattern);
+        for(unsigned int i = 0; i < pattern.length();){
+            int lcp = get_lcp(pattern, i, hh_string, node, end - i);
+            node += lcp;
+            i += lcp;
+            if(i == pattern.length()){
+                break;
+            }
+            auto light_to = light_edges.find(node, pattern[i]);
+            if(light_to){
+                node = light_to.value();
+            }
+            else{
+                return std::nullopt;
+            }
+            ++i;
+        }
+        return node;
+    }
+    std::pair<std::uint64_t, int> longest_prefix(std::string_view pattern) const override{
+        unsigned int node = source;
+        unsigned int i = 0;
+        std::uint64_t end = hh_match_end(pattern);
+        while(i < pattern.length()){
+            int lcp = get_lcp(pattern, i, hh_string, node, end - i);
+            node += lcp;
+            i += lcp;
+            if(i == pattern.length()){
+                break;
+            }
+            auto light_to = light_edges.find(node, pattern[i]);
+            if(!light_to){
+                break;
+            }
+            node = light_to.value();
+            ++i;
+        }
+        return {i, node};
+    }
+    std::uint64_t count(std::string_view pattern) const override{
+        auto node = get_node(pattern);
+        return node ? counts[node.value()] : 0;
+    }
+    void locate(std::string_view pattern, const std::function<void(std::uint64_t)>& callback) const override{
+        auto node = get_node(pattern);
+        if(node){
+            // the image was saved from an index built with locate
+            assert(locate_lo.size() != 0);
+            LocateTable::report(locate_lo, locate_positions, node.value(), counts[node.value()], pattern.length(), callback);
+        }
+    }
+    virtual std::uint64_t num_bytes() const{
+        return reader.num_bytes();
+    }
+};
+
+// HeavyTreeDAWG saved by HeavyTreeDAWG::save
+class MappedHeavyTreeDAWG : public FullTextIndex {
+    image::Reader reader;
+    std::string_view text_view;
+    std::span<const int> poses;
+    std::span<const int> heavy_edge_to;
+    MappedLightEdges light_edges;
+    PackedSpan counts;
+    PackedSpan locate_lo, locate_positions;
+public:
+    static constexpr image::Kind kind = image::Kind::HeavyTree;
+    explicit MappedHeavyTreeDAWG(const std::string& path) :
+        reader(path, kind),
+        text_view([this]{
+            auto text = reader.get<char>(image::Section::Text);
+            return std::string_view(text.data(), text.size());
+        }()),
+        poses(reader.get<int>(image::Section::Poses)),
+        heavy_edge_to(reader.get<int>(image::Section::HeavyEdgeTo)),
+        light_edges(reader),
+        counts(reader.get<std::uint64_t>(image::Section::Counts)),
+        locate_lo(optional_packed_section(reader, image::Section::LocateLo)),
+        locate_positions(optional_packed_section(reader, image::Section::LocatePositions)){
+        assert(poses.size() == heavy_edge_to.size());
+        assert(light_edges.offsets.size() == poses.size() + 1);
+    }
+    std::optional<int> get_node(std::string_view pattern) const override{
+        unsigned int node = 0;
+        for(unsigned int i = 0; i < pattern.length();){
+            int pos = poses[node];
+            int lcp = get_lcp(text_view, pos, pattern, i, std::min(text_view.length() - pos, pattern.length() - i));
+            node = get_anc(node, lcp);
+            i += lcp;
+            if(i == pattern.length()){
+                break;
+            }
+            auto light_to = light_edges.find(node, pattern[i]);
+            if(light_to){
+                node = light_to.value();
+            }
+            else{
+                return std::nullopt;
+            }
+            ++i;
+        }
+        return node;
+    }
+    std::pair<std::uint64_t, int> longest_prefix(std::string_view pattern) const override{
+        unsigned int node = 0;
+        unsigned int i = 0;
+        while(i < pattern.length()){
+            int pos = poses[node];
+            int lcp = get_lcp(text_view, pos, pattern, i, std::min(text_view.length() - pos, pattern.length() - i));
+            node = get_anc(node, lcp);
+            i += lcp;
+            if(i == pattern.length()){
+                break;
+            }
+            auto light_to = light_edges.find(node, pattern[i]);
+            if(!light_to){
+                break;
+            }
+            node = light_to.value();
+            ++i;
+        }
+        return {i, node};
+    }
+    std::uint64_t count(std::string_view pattern) const override{
+        auto node = get_node(pattern);
+        return node ? counts[node.value()] : 0;
+    }
+    void locate(std::string_view pattern, const std::function<void(std::uint64_t)>& callback) const override{
+        auto node = get_node(pattern);
+        if(node){
+            // the image was saved from an index built with locate
+            assert(locate_lo.size() != 0);
+            LocateTable::report(locate_lo, locate_positions, node.value(), counts[node.value()], pattern.length(), callback);
+        }
+    }
+    inline int get_anc(int node, int k) const{
+        for(int i = 0; i < k; ++i){
+            node = heavy_edge_to[node];
+        }
+        return node;
+    }
+    virtual std::uint64_t num_bytes() const{
+        return reader.num_bytes();
+    }
+};
+
+#endif //PACKED_DAWG_MAPPED_DAWG_HPP
@@ -0,0 +1,54 @@
+#ifndef PACKED_DAWG_MATCHING_STATISTICS_HPP
+#define PACKED_DAWG_MATCHING_STATISTICS_HPP
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <string_view>
+
+#include "packed_vector.hpp"
+
+// Suffix links of a static index in its own node order, bit-packed.
+// target(x) is the suffix link of x and length(x) the len of that node, i.e. the match length left after following it.
+// The source links to itself with length 0.
+class SuffixLinks{
+    PackedVector targets;
+    PackedVector lengths;
+public:
+    SuffixLinks() = default;
+    // order[i]: DAWG node of index node i, rename(y): index node of DAWG node y
+    template<typename Int, typename Rename>
+    SuffixLinks(Int n, const std::vector<Int>& order, const std::vector<Int>& slink, const std::vector<Int>& len, Rename rename){
+        std::vector<Int> targets_(n), lengths_(n);
+        for(Int i = 0; i < n; ++i){
+            Int x = order.empty() ? i : order[i];
+            targets_[i] = slink[x] == -1 ? i : rename(slink[x]);
+            lengths_[i] = slink[x] == -1 ? 0 : len[slink[x]];
+        }
+        targets = PackedVector(targets_);
+        lengths = PackedVector(lengths_);
+    }
+    std::uint64_t target(std::uint64_t x) const{
+        return targets[x];
+    }
+    std::uint64_t length(std::uint64_t x) const{
+        return lengths[x];
+    }
+    std::uint64_t num_bytes() const{
+        return targets.num_bytes() + lengths.num_bytes();
+    }
+};
+
+// {start in query, length} of a longest substring of the query that occurs in the text
+template<typename Index>
+std::pair<std::uint64_t, std::uint64_t> longest_common_substring(const Index& index, std::string_view query){
+    std::pair<std::uint64_t, std::uint64_t> best = {0, 0};
+    index.matching_statistics(query, [&](std::uint64_t i, std::uint64_t length){
+        if(best.second < length){
+            best = {i + 1 - length, length};
+        }
+    });
+    return best;
+}
+
+#endif //PACKED_DAWG_MATCHING_STATISTICS_HPP
@@ -0,0 +1,151 @@
+#ifndef PACKED_DAWG_PACKED_VECTOR_HPP
+#define PACKED_DAWG_PACKED_VECTOR_HPP
+
+#include <bit>
+#include <span>
+#include <vector>
+#include <ostream>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+// i-th `width`-bit value of a packed array. Branch-free: one unaligned 8-byte load at the byte
+// holding the first bit, so width <= 57 and the array needs one word of padding at the end.
+inline std::uint64_t packed_get(const std::uint64_t* words, unsigned int width, std::uint64_t i){
+    std::uint64_t bit = i * width;
+    std::uint64_t word;
+    std::memcpy(&word, reinterpret_cast<const char*>(words) + (bit >> 3u), sizeof(word));
+    return (word >> (bit & 7u)) & (~std::uint64_t(0) >> (64u - width));
+}
+
+// fixed-width bit-packed unsigned integers, width = bits of the largest value
+class PackedVector{
+    std::vector<std::uint64_t> words;
+    std::uint64_t _size;
+    unsigned int _width;
+public:
+    PackedVector() : words(1, 0), _size(0), _width(1){}
+    PackedVector(std::uint64_t size, unsigned int width) : words((size * width + 63) / 64 + 1, 0), _size(size), _width(width){
+        assert(1 <= width && width <= 57);
+    }
+    template<typename T>
+    explicit PackedVector(const std::vector<T>& values) : PackedVector(values.size(), bits_for(values)){
+        for(std::uint64_t i = 0; i < values.size(); ++i){
+            set(i, values[i]);
+        }
+    }
+    template<typename T>
+    static unsigned int bits_for(const std::vector<T>& values){
+        std::uint64_t max_value = 0;
+        for(auto value : values){
+            assert(value >= 0);
+            max_value = std::max<std::uint64_t>(max_value, value);
+        }
+        return std::max<unsigned int>(1, std::bit_width(max_value));
+    }
+    std::uint64_t operator[](std::uint64_t i) const{
+        return packed_get(words.data(), _width, i);
+    }
+    // read-modify-write of the same unaligned 8 bytes packed_get loads
+    void set(std::uint64_t i, std::uint64_t value){
+        std::uint64_t mask = ~std::uint64_t(0) >> (64u - _width);
+        assert(value == (value & mask));
+        std::uint64_t bit = i * _width;
+        char* ptr = reinterpret_cast<char*>(words.data()) + (bit >> 3u);
+        std::uint64_t word;
+        std::memcpy(&word, ptr, sizeof(word));
+        word = (word & ~(mask << (bit & 7u))) | (value << (bit & 7u));
+        std::memcpy(ptr, &word, sizeof(word));
+    }
+    // the word holding the i-th value, for interleaved queries
+    void prefetch(std::uint64_t i) const{
+        __builtin_prefetch(words.data() + ((i * _width) >> 6u));
+    }
+    template<typename T>
+    std::vector<T> to_vector() const{
+        std::vector<T> res(_size);
+        for(std::uint64_t i = 0; i < _size; ++i){
+            res[i] = static_cast<T>((*this)[i]);
+        }
+        return res;
+    }
+    std::uint64_t size() const{
+        return _size;
+    }
+    unsigned int width() const{
+        return _width;
+    }
+    // [width, size, words...] as stored in an on-disk image
+    std::vector<std::uint64_t> image() const{
+        std::vector<std::uint64_t> res = {_width, _size};
+        res.insert(res.end(), words.begin(), words.end());
+        return res;
+    }
+    std::uint64_t num_bytes() const{
+        return words.capacity() * sizeof(std::uint64_t) + sizeof(_size) + sizeof(_width) + 2 * sizeof(std::size_t);
+    }
+};
+
+// PackedVector::image() of `size` values pushed one at a time, written to a stream without the vector in memory
+class PackedImageWriter{
+    std::ostream& out;
+    unsigned int width;
+    std::uint64_t word = 0;
+    unsigned int filled = 0;
+    std::uint64_t words_left;
+    void put(std::uint64_t w){
+        assert(words_left > 0);
+        out.write(reinterpret_cast<const char*>(&w), sizeof(w));
+        --words_left;
+    }
+public:
+    PackedImageWriter(std::ostream& out, std::uint64_t size, unsigned int width) : out(out), width(width), words_left((size * width + 63) / 64 + 1){
+        assert(1 <= width && width <= 57);
+        std::uint64_t head[2] = {width, size};
+        out.write(reinterpret_cast<const char*>(head), sizeof(head));
+    }
+    void push(std::uint64_t value){
+        assert(value == (value & (~std::uint64_t(0) >> (64u - width))));
+        word |= value << filled;
+        filled += width;
+        if(filled >= 64){
+            put(word);
+            filled -= 64;
+            word = value >> (width - filled);
+        }
+    }
+    // the last partial word and the padding word
+    void finish(){
+        if(filled > 0){
+            put(word);
+            filled = 0;
+        }
+        while(words_left > 0){
+            put(0);
+        }
+    }
+    static std::uint64_t num_bytes(std::uint64_t size, unsigned int width){
+        return ((size * width + 63) / 64 + 3) * sizeof(std::uint64_t);
+    }
+};
+
+// read-only view of PackedVector::image(), e.g. on mapped pages
+class PackedSpan{
+    const std::uint64_t* words = nullptr;
+    std::uint64_t _size = 0;
+    unsigned int _width = 1;
+public:
+    PackedSpan() = default;
+    explicit PackedSpan(std::span<const std::uint64_t> image) : words(image.data() + 2), _size(image[1]), _width(image[0]){
+        assert(image.size() == (_size * _width + 63) / 64 + 3);
+    }
+    std::uint64_t operator[](std::uint64_t i) const{
+        return packed_get(words, _width, i);
+    }
+    std::uint64_t size() const{
+        return _size;
+    }
+};
+
+#endif //PACKED_DAWG_PACKED_VECTOR_HPP
@@ -0,0 +1,133 @@
+#ifndef PACKED_DAWG_PREFIX_TABLE_HPP
+#define PACKED_DAWG_PREFIX_TABLE_HPP
+
+#include <bit>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+#include "packed_vector.hpp"
+
+// The node of every string of length 1..k (k <= 4) that occurs in the text, so that a query starts past the
+// first min(k, m) characters of its pattern instead of walking them from the source.
+// k <= 2: a dense array indexed by the bytes (256 + 65536 entries, node + 1 or 0).
+// k = 3, 4: open addressing over one slot per string holding the string's key and its node, so a lookup
+// is usually a single cache miss. A slot is 64 bits for 31-bit node ids (Int = int), 128 bits for std::int64_t.
+// Every occurring string is stored, so a prefix missing from the table means the pattern does not occur.
+template<typename Int>
+class BasicPrefixTable{
+    using Slot = std::conditional_t<sizeof(Int) <= 4, std::uint64_t, unsigned __int128>;
+    static constexpr unsigned int node_bits = sizeof(Int) <= 4 ? 31 : 64;
+    unsigned int k = 0;
+    PackedVector dense;
+    // (key << node_bits) | node, 0 for an empty slot
+    std::vector<Slot> slots;
+    unsigned int shift = 0;
+
+    // the bytes after a leading 1: distinct over all lengths and never 0, at most 33 bits
+    static std::uint64_t key(std::string_view prefix){
+        std::uint64_t res = 1;
+        for(unsigned char c : prefix){
+            res = (res << 8u) | c;
+        }
+        return res;
+    }
+    static std::uint64_t dense_index(std::string_view prefix){
+        auto first = static_cast<unsigned char>(prefix[0]);
+        return prefix.length() == 1 ? first : 256 + (first << 8u | static_cast<unsigned char>(prefix[1]));
+    }
+    std::uint64_t slot_of(std::uint64_t key) const{
+        return (key * 0x9E3779B97F4A7C15ull) >> shift;
+    }
+
+public:
+    BasicPrefixTable() = default;
+    // get_node(string) of the index, for the strings of length 1..k that occur, found level by level
+    template<typename GetNode>
+    BasicPrefixTable(unsigned int k, GetNode get_node) : k(k){
+        assert(1 <= k && k <= 4);
+        std::vector<std::pair<std::string, Int>> entries;
+        std::vector<std::string> level = {""};
+        for(unsigned int length = 1; length <= k; ++length){
+            std::vector<std::string> next;
+            for(const auto& prefix : level){
+                for(int c = 0; c < 256; ++c){
+                    std::string s = prefix + static_cast<char>(c);
+                    if(auto node = get_node(std::string_view(s))){
+                        assert(node.value() >= 0);
+                        entries.emplace_back(s, node.value());
+                        next.emplace_back(std::move(s));
+                    }
+                }
+            }
+            level = std::move(next);
+        }
+        if(k <= 2){
+            std::vector<Int> dense_(k == 1 ? 256 : 256 + 65536, 0);
+            for(const auto& [s, node] : entries){
+                dense_[dense_index(s)] = node + 1;
+            }
+            dense = PackedVector(dense_);
+            return;
+        }
+        // load factor at most 1/2
+        std::uint64_t capacity = std::bit_ceil(std::max<std::uint64_t>(2, 2 * entries.size()));
+        shift = 64 - std::countr_zero(capacity);
+        slots.assign(capacity, 0);
+        for(const auto& [s, node] : entries){
+            std::uint64_t h = slot_of(key(s));
+            while(slots[h] != 0){
+                h = (h + 1) & (capacity - 1);
+            }
+            slots[h] = Slot(key(s)) << node_bits | static_cast<std::make_unsigned_t<Int>>(node);
+        }
+    }
+
+    bool empty() const{
+        return k == 0;
+    }
+    // node of a string of length 1..k, std::nullopt if it does not occur
+    std::optional<Int> find(std::string_view prefix) const{
+        assert(1 <= prefix.length() && prefix.length() <= k);
+        if(k <= 2){
+            std::uint64_t res = dense[dense_index(prefix)];
+            return res == 0 ? std::nullopt : std::optional<Int>(res - 1);
+        }
+        std::uint64_t tag = key(prefix);
+        for(std::uint64_t h = slot_of(tag); slots[h] != 0; h = (h + 1) & (slots.size() - 1)){
+            if(slots[h] >> node_bits == tag){
+                return static_cast<Int>(slots[h] & ((Slot(1) << node_bits) - 1));
+            }
+        }
+        return std::nullopt;
+    }
+    // moves a traversal at (source, 0) to (node, i) past the first min(k, m) characters of the pattern.
+    // false if those do not occur (so neither does the pattern), leaving node and i unchanged.
+    // Always true, and a no-op, for an empty table or pattern.
+    template<typename Node>
+    bool seek(std::string_view pattern, Node& node, unsigned int& i) const{
+        if(k == 0 || pattern.empty()){
+            return true;
+        }
+        std::string_view prefix = pattern.substr(0, k);
+        auto res = find(prefix);
+        if(!res){
+            return false;
+        }
+        node = res.value();
+        i = prefix.length();
+        return true;
+    }
+    std::uint64_t num_bytes() const{
+        return sizeof(k) + sizeof(shift) + dense.num_bytes() + slots.capacity() * sizeof(Slot) + 2 * sizeof(std::size_t);
+    }
+};
+
+using PrefixTable = BasicPrefixTable<int>;
+
+#endif //PACKED_DAWG_PREFIX_TABLE_HPP
@@ -0,0 +1,131 @@
+#ifndef PACKED_DAWG_RLZ_HPP
+#define PACKED_DAWG_RLZ_HPP
+
+#include <string>
+#include <thread>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+#include <string_view>
+
+#include "heavy_path_builder.hpp"
+
+// Relative Lempel-Ziv: the input as a sequence of phrases copied from a reference text.
+// A phrase is reference[pos .. pos + len), or the literal byte pos when len = 0
+// (a byte that does not occur in the reference).
+struct RLZFactor{
+    std::uint64_t pos, len;
+    bool operator==(const RLZFactor&) const = default;
+};
+
+namespace rlz {
+
+// number of input bytes covered by the factor
+inline std::uint64_t length(const RLZFactor& factor){
+    return std::max<std::uint64_t>(factor.len, 1);
+}
+
+// the greedy phrase at input[i..]: the longest prefix that occurs in the reference (index.longest_prefix)
+// at one of its stored positions (index.occurrence, so the index is built with locate)
+template<typename Index>
+RLZFactor next_factor(const Index& index, std::string_view input, std::uint64_t i){
+    auto [len, node] = index.longest_prefix(input.substr(i));
+    if(len == 0){
+        return {static_cast<unsigned char>(input[i]), 0};
+    }
+    return {index.occurrence(node, len), len};
+}
+
+// greedy factors from input[begin..] until a phrase would start at or after `end`; fn(start, factor) for each
+template<typename Index, typename Fn>
+std::uint64_t parse(const Index& index, std::string_view input, std::uint64_t begin, std::uint64_t end, Fn fn){
+    std::uint64_t i = begin;
+    while(i < end){
+        RLZFactor factor = next_factor(index, input, i);
+        fn(i, factor);
+        i += length(factor);
+    }
+    return i;
+}
+
+}
+
+// greedy RLZ factorisation of the input against the reference indexed by `index`
+// (HeavyPathDAWG or HeavyTreeDAWG: longest_prefix for the phrase, stored positions for its source)
+template<typename Index>
+std::vector<RLZFactor> rlz_factorize(const Index& index, std::string_view input){
+    std::vector<RLZFactor> factors;
+    rlz::parse(index, input, 0, input.length(), [&](std::uint64_t, const RLZFactor& factor){
+        factors.emplace_back(factor);
+    });
+    return factors;
+}
+
+// rlz_factorize with the input split into num_threads chunks parsed concurrently. A chunk is parsed from its
+// first byte, so its first phrases may differ from the sequential parse, whose phrase from the previous chunk can
+// run past the boundary. The stitch parses on from where the previous chunk really ends until it reaches a phrase
+// start of the chunk's own parse: the greedy parse from a position is unique, so from there on they agree and
+// the result equals rlz_factorize exactly.
+template<typename Index>
+std::vector<RLZFactor> rlz_factorize_parallel(const Index& index, std::string_view input, int num_threads = num_build_threads()){
+    struct Chunk{
+        std::vector<std::uint64_t> starts;
+        std::vector<RLZFactor> factors;
+    };
+    std::uint64_t n = input.length();
+    num_threads = std::max<std::uint64_t>(1, std::min<std::uint64_t>(num_threads, n / 4096));
+    std::vector<Chunk> chunks(num_threads);
+    std::vector<std::thread> threads;
+    for(int t = 0; t < num_threads; ++t){
+        threads.emplace_back([&, t]{
+            rlz::parse(index, input, n * t / num_threads, n * (t + 1) / num_threads, [&](std::uint64_t i, const RLZFactor& factor){
+                chunks[t].starts.emplace_back(i);
+                chunks[t].factors.emplace_back(factor);
+            });
+        });
+    }
+    for(auto& thread : threads){
+        thread.join();
+    }
+
+    std::vector<RLZFactor> factors;
+    std::uint64_t i = 0;
+    for(const auto& chunk : chunks){
+        // repair until the parse meets a phrase start of this chunk
+        auto it = std::lower_bound(chunk.starts.begin(), chunk.starts.end(), i);
+        while(it != chunk.starts.end() && *it != i){
+            RLZFactor factor = rlz::next_factor(index, input, i);
+            factors.emplace_back(factor);
+            i += rlz::length(factor);
+            it = std::lower_bound(it, chunk.starts.end(), i);
+        }
+        if(it == chunk.starts.end()){
+            continue;
+        }
+        std::size_t k = it - chunk.starts.begin();
+        factors.insert(factors.end(), chunk.factors.begin() + k, chunk.factors.end());
+        i = chunk.starts.back() + rlz::length(chunk.factors.back());
+    }
+    // a repaired phrase can also jump past every start of the last chunk
+    rlz::parse(index, input, i, n, [&](std::uint64_t, const RLZFactor& factor){
+        factors.emplace_back(factor);
+    });
+    return factors;
+}
+
+// the input of rlz_factorize
+inline std::string rlz_decode(std::string_view reference, const std::vector<RLZFactor>& factors){
+    std::string res;
+    for(const auto& factor : factors){
+        if(factor.len == 0){
+            res.push_back(static_cast<char>(factor.pos));
+        }
+        else{
+            res.append(reference.substr(factor.pos, factor.len));
+        }
+    }
+    return res;
+}
+
+#endif //PACKED_DAWG_RLZ_HPP
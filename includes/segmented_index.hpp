@@ -0,0 +1,300 @@
+#ifndef PACKED_DAWG_SEGMENTED_INDEX_HPP
+#define PACKED_DAWG_SEGMENTED_INDEX_HPP
+
+#include <mutex>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <functional>
+#include <shared_mutex>
+#include <condition_variable>
+
+#include "full_text_index.hpp"
+#include "dawg.hpp"
+
+// Append-only index over a growing text, LSM style.
+// text = [segment][segment]...[tail]. append() feeds the tail, a mutable DAWGBase that answers queries directly.
+// When the tail reaches tail_limit it is frozen into a level-0 segment and a background thread builds its
+// HeavyPathDAWG. Runs of `fanout` built segments of one level are rebuilt into one segment of the next
+// level, so there are O(fanout * log(|text| / tail_limit)) segments.
+// Until its HeavyPathDAWG is ready, a frozen segment answers from its DAWGBase and the |endpos| of its nodes,
+// computed at freezing.
+// Occurrences inside one part come from that part. Occurrences crossing a boundary are found by scanning
+// the m - 1 characters on each side of it and are attributed to the first boundary they cross.
+// The tail keeps no positions: count() and locate() on it, and locate() on a segment not yet built, scan the
+// whole part (up to tail_limit characters, 64 KiB by default) once the pattern is known to occur there,
+// however few occurrences it has.
+// get_node() returns the node of the pattern in the automaton of the first part (segments in text order, then the
+// tail) that holds it: a HeavyPathDAWG id for a built segment, a DAWGBase id otherwise. The id means nothing without
+// its part, which is not returned, so outside of this class it is an existence test. A pattern that occurs only
+// across a boundary is in no part's automaton and gets -1.
+template <template <typename, typename> typename MapType>
+class SegmentedIndex : public FullTextIndex {
+    struct Segment{
+        std::uint64_t begin, end;
+        int level;
+        // base and the |endpos| of its nodes until index is built
+        std::shared_ptr<const DAWGBase> base;
+        std::vector<int> counts;
+        std::shared_ptr<const HeavyPathDAWG<MapType>> index;
+    };
+
+    std::uint64_t tail_limit;
+    int fanout;
+    std::string text;
+    std::vector<Segment> segments;
+    std::unique_ptr<DAWGBase> tail;
+    std::uint64_t tail_begin = 0;
+    // text, segments, tail: shared by queries, exclusive for append() and swapping in a built segment
+    mutable std::shared_mutex mutex;
+
+    // requests: frozen tails not yet seen by the worker
+    std::mutex work_mutex;
+    std::condition_variable work_cv, idle_cv;
+    std::uint64_t requests = 0;
+    bool stopping = false, busy = false;
+    std::thread worker;
+
+    // node reached by pattern from the source of base, if any
+    static std::optional<int> walk(const DAWGBase& base, std::string_view pattern){
+        int node = 0;
+        for(char c : pattern){
+            auto next = base.find(node, c);
+            if(!next){
+                return std::nullopt;
+            }
+            node = next.value();
+        }
+        return node;
+    }
+    // fn(start) for each occurrence of pattern starting in [lo, hi) of text
+    template<typename Fn>
+    void scan(std::string_view pattern, std::uint64_t lo, std::uint64_t hi, Fn fn) const{
+        std::string_view window = std::string_view(text).substr(lo, std::min<std::uint64_t>(text.size(), hi + pattern.length() - 1) - lo);
+        for(auto pos = window.find(pattern); pos != std::string_view::npos; pos = window.find(pattern, pos + 1)){
+            fn(lo + pos);
+        }
+    }
+    // fn(start) for each occurrence inside the segment
+    template<typename Fn>
+    void report(const Segment& segment, std::string_view pattern, Fn fn) const{
+        if(segment.index){
+            segment.index->locate(pattern, [&](std::uint64_t pos){ fn(segment.begin + pos); });
+        }
+        else if(walk(*segment.base, pattern)){
+            scan(pattern, segment.begin, segment.end - pattern.length() + 1, fn);
+        }
+    }
+    // fn(start) for each occurrence crossing the end of segments[k] and no earlier boundary
+    template<typename Fn>
+    void report_boundary(std::size_t k, std::string_view pattern, Fn fn) const{
+        std::uint64_t b = segments[k].end;
+        if(pattern.length() >= 2 && b + 1 <= text.size()){
+            scan(pattern, std::max<std::uint64_t>(segments[k].begin, b - std::min<std::uint64_t>(b, pattern.length() - 1)), b, fn);
+        }
+    }
+    // fn(start) for each occurrence inside the tail
+    template<typename Fn>
+    void report_tail(std::string_view pattern, Fn fn) const{
+        if(walk(*tail, pattern)){
+            scan(pattern, tail_begin, text.size() - pattern.length() + 1, fn);
+        }
+    }
+
+    void freeze_tail(){
+        if(tail_begin == text.size()){
+            return;
+        }
+        auto counts = tail->occurrence_counts(tail->topological_order());
+        segments.push_back({tail_begin, text.size(), 0, std::shared_ptr<const DAWGBase>(std::move(tail)), std::move(counts), nullptr});
+        tail = std::make_unique<DAWGBase>();
+        tail_begin = text.size();
+        {
+            std::lock_guard lock(work_mutex);
+            ++requests;
+        }
+        work_cv.notify_one();
+    }
+
+    // builds the first unbuilt segment or merges the first run of `fanout` built segments of one level;
+    // false if there was nothing to do
+    bool step(){
+        std::uint64_t begin, end;
+        int level;
+        std::size_t first, last;
+        std::string part;
+        {
+            std::shared_lock lock(mutex);
+            auto unbuilt = std::find_if(segments.begin(), segments.end(), [](const Segment& s){ return !s.index; });
+            if(unbuilt != segments.end()){
+                first = last = unbuilt - segments.begin();
+                level = unbuilt->level;
+            }
+            else{
+                first = segments.size();
+                for(std::size_t k = 0; k + fanout <= segments.size(); ++k){
+                    if(std::all_of(segments.begin() + k, segments.begin() + k + fanout, [&](const Segment& s){ return s.level == segments[k].level; })){
+                        first = k;
+                        break;
+                    }
+                }
+                if(first == segments.size()){
+                    return false;
+                }
+                last = first + fanout - 1;
+                level = segments[first].level + 1;
+            }
+            begin = segments[first].begin;
+            end = segments[last].end;
+            part = text.substr(begin, end - begin);
+        }
+        auto index = std::make_shared<const HeavyPathDAWG<MapType>>(part, true);
+        std::unique_lock lock(mutex);
+        // only this thread removes segments, so [first, last] still covers [begin, end)
+        assert(segments[first].begin == begin && segments[last].end == end);
+        segments[first] = {begin, end, level, nullptr, {}, std::move(index)};
+        segments.erase(segments.begin() + first + 1, segments.begin() + last + 1);
+        return true;
+    }
+
+    void run(){
+        while(true){
+            {
+                std::unique_lock lock(work_mutex);
+                work_cv.wait(lock, [&]{ return stopping || requests > 0; });
+                if(stopping){
+                    return;
+                }
+                requests = 0;
+                busy = true;
+            }
+            while(step()){}
+            {
+                std::lock_guard lock(work_mutex);
+                busy = false;
+            }
+            idle_cv.notify_all();
+        }
+    }
+
+public:
+    explicit SegmentedIndex(std::uint64_t tail_limit = 1 << 16, int fanout = 4) : tail_limit(tail_limit), fanout(fanout), tail(std::make_unique<DAWGBase>()){
+        assert(tail_limit >= 1 && fanout >= 2);
+        worker = std::thread([this]{ run(); });
+    }
+    // FullTextIndex-style construction: the whole text as one append, built synchronously
+    explicit SegmentedIndex(std::string_view text) : SegmentedIndex(){
+        append(text);
+        flush();
+    }
+    SegmentedIndex(const SegmentedIndex&) = delete;
+    SegmentedIndex& operator=(const SegmentedIndex&) = delete;
+    ~SegmentedIndex(){
+        {
+            std::lock_guard lock(work_mutex);
+            stopping = true;
+        }
+        work_cv.notify_one();
+        worker.join();
+    }
+
+    void append(std::string_view chunk){
+        std::unique_lock lock(mutex);
+        for(char c : chunk){
+            tail->add_node(text.size() - tail_begin, c);
+            text.push_back(c);
+            if(text.size() - tail_begin >= tail_limit){
+                freeze_tail();
+            }
+        }
+    }
+    // freezes the tail and waits until every segment is built and merged
+    void flush(){
+        {
+            std::unique_lock lock(mutex);
+            freeze_tail();
+        }
+        std::unique_lock lock(work_mutex);
+        idle_cv.wait(lock, [&]{ return requests == 0 && !busy; });
+    }
+    std::uint64_t size() const{
+        std::shared_lock lock(mutex);
+        return text.size();
+    }
+    std::size_t num_segments() const{
+        std::shared_lock lock(mutex);
+        return segments.size();
+    }
+
+    std::optional<int> get_node(std::string_view pattern) const override{
+        std::shared_lock lock(mutex);
+        bool crossing = false;
+        auto mark = [&](std::uint64_t){ crossing = true; };
+        for(std::size_t k = 0; k < segments.size(); ++k){
+            auto node = segments[k].index ? segments[k].index->get_node(pattern) : walk(*segments[k].base, pattern);
+            if(node){
+                return node;
+            }
+            if(!crossing){
+                report_boundary(k, pattern, mark);
+            }
+        }
+        if(auto node = walk(*tail, pattern)){
+            return node;
+        }
+        if(crossing){
+            return -1;
+        }
+        return std::nullopt;
+    }
+    std::uint64_t count(std::string_view pattern) const override{
+        std::shared_lock lock(mutex);
+        if(pattern.empty()){
+            return text.size() + 1;
+        }
+        std::uint64_t res = 0;
+        auto add = [&](std::uint64_t){ ++res; };
+        for(std::size_t k = 0; k < segments.size(); ++k){
+            if(segments[k].index){
+                res += segments[k].index->count(pattern);
+            }
+            else if(auto node = walk(*segments[k].base, pattern)){
+                res += segments[k].counts[node.value()];
+            }
+            report_boundary(k, pattern, add);
+        }
+        report_tail(pattern, add);
+        return res;
+    }
+    void locate(std::string_view pattern, const std::function<void(std::uint64_t)>& callback) const override{
+        std::shared_lock lock(mutex);
+        if(pattern.empty()){
+            for(std::uint64_t pos = 0; pos <= text.size(); ++pos){
+                callback(pos);
+            }
+            return;
+        }
+        for(std::size_t k = 0; k < segments.size(); ++k){
+            report(segments[k], pattern, callback);
+            report_boundary(k, pattern, callback);
+        }
+        report_tail(pattern, callback);
+    }
+    std::uint64_t num_bytes() const override{
+        std::shared_lock lock(mutex);
+        auto base_bytes = [](const DAWGBase& base){
+            return base.nodes.capacity() * sizeof(DAWGBase::Node) + base.arena.capacity() * sizeof(DAWGBase::Edge);
+        };
+        std::uint64_t size = text.capacity() + 2 * sizeof(std::size_t);
+        size += base_bytes(*tail);
+        for(const auto& segment : segments){
+            size += segment.index ? segment.index->num_bytes() : base_bytes(*segment.base) + segment.counts.capacity() * sizeof(int);
+        }
+        return size;
+    }
+};
+
+#endif //PACKED_DAWG_SEGMENTED_INDEX_HPP
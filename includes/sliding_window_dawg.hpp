@@ -0,0 +1,140 @@
+#ifndef PACKED_DAWG_SLIDING_WINDOW_DAWG_HPP
+#define PACKED_DAWG_SLIDING_WINDOW_DAWG_HPP
+
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <optional>
+#include <algorithm>
+#include <string_view>
+
+#include "dawg.hpp"
+
+// DAWG of the last `width` characters of an unbounded stream, in O(width) memory.
+// Two online DAWGBases: `older` over buffer = stream[begin, end), `newer` over stream[pivot, end).
+// Every character is appended to both. When newer reaches width characters it replaces older
+// (so begin = pivot - width) and a new, empty newer starts at pivot = end; dropping the old automaton
+// and the evicted prefix of the buffer costs O(width) once per width appends, amortised O(1).
+//
+// The window stream[end - width, end) is a suffix of buffer, so its substrings are nodes of older; a node
+// found there is in the window iff one of its occurrences starts at or after the window start. These are
+// - occurrences ending at or before pivot: last_end[x], the last such end in buffer, fixed at the rotation
+//   (a clone made later inherits it from the node it was split from, nodes made later have none)
+// - occurrences after pivot: the pattern is a node of newer
+// - occurrences across pivot: a scan of the 2(m - 1) characters around it.
+class SlidingWindowDAWG{
+    std::uint64_t width;
+    std::uint64_t begin = 0, pivot = 0, end = 0;
+    std::string buffer;
+    DAWGBase older, newer;
+    // one past the last end in buffer of the node's strings before pivot, 0 if none
+    std::vector<int> last_end;
+
+    static std::optional<int> walk(const DAWGBase& base, std::string_view pattern){
+        int node = 0;
+        for(char c : pattern){
+            auto next = base.find(node, c);
+            if(!next){
+                return std::nullopt;
+            }
+            node = next.value();
+        }
+        return node;
+    }
+
+    void rotate(){
+        older = std::move(newer);
+        newer = DAWGBase();
+        buffer.erase(0, pivot - begin);
+        begin = pivot;
+        pivot = end;
+        // max over the suffix-link subtree of the prefix ends (non-cloned nodes), children have larger len
+        const auto& nodes = older.nodes;
+        last_end.assign(nodes.size(), 0);
+        for(std::size_t x = 1; x < nodes.size(); ++x){
+            if(!nodes[x].cloned){
+                last_end[x] = nodes[x].len;
+            }
+        }
+        auto order = older.topological_order();
+        for(auto it = order.rbegin(); it != order.rend(); ++it){
+            int x = *it;
+            if(nodes[x].slink != -1){
+                last_end[nodes[x].slink] = std::max(last_end[nodes[x].slink], last_end[x]);
+            }
+        }
+    }
+
+public:
+    explicit SlidingWindowDAWG(std::uint64_t width) : width(width), last_end(1, 0){
+        assert(width >= 1);
+    }
+
+    void append(std::string_view chunk){
+        for(char c : chunk){
+            int split = older.add_node(end - begin, c);
+            last_end.resize(older.nodes.size(), 0);
+            if(split != -1){
+                last_end.back() = last_end[split];
+            }
+            newer.add_node(end - pivot, c);
+            buffer.push_back(c);
+            ++end;
+            if(end - pivot == width){
+                rotate();
+            }
+        }
+    }
+
+    // the last min(width, stream length) characters
+    std::string_view window() const{
+        std::uint64_t length = std::min(width, end);
+        return std::string_view(buffer).substr(buffer.size() - length);
+    }
+    // number of characters appended so far
+    std::uint64_t size() const{
+        return end;
+    }
+
+    // a node of the current window's automaton for the pattern, valid until the next append
+    std::optional<int> get_node(std::string_view pattern) const{
+        auto node = walk(older, pattern);
+        if(!node || pattern.empty()){
+            return node;
+        }
+        std::uint64_t m = pattern.length();
+        std::uint64_t window_begin = end - std::min(width, end);
+        if(last_end[node.value()] != 0 && begin + last_end[node.value()] - m >= window_begin){
+            return node;
+        }
+        if(walk(newer, pattern)){
+            return node;
+        }
+        if(m >= 2 && pivot > begin){
+            std::uint64_t lo = std::max(window_begin, pivot - std::min(pivot, m - 1));
+            std::uint64_t hi = std::min(end, pivot + m - 1);
+            if(lo < hi && std::string_view(buffer).substr(lo - begin, hi - lo).find(pattern) != std::string_view::npos){
+                return node;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::uint64_t num_bytes() const{
+        auto base_bytes = [](const DAWGBase& base){
+            std::uint64_t size = base.nodes.capacity() * sizeof(DAWGBase::Node) + base.arena.capacity() * sizeof(DAWGBase::Edge);
+            for(const auto& blocks : base.free_blocks){
+                size += blocks.capacity() * sizeof(std::uint32_t);
+            }
+            return size;
+        };
+        std::uint64_t size = buffer.capacity() + 2 * sizeof(std::size_t);
+        size += base_bytes(older) + base_bytes(newer);
+        size += last_end.capacity() * sizeof(int) + 2 * sizeof(std::size_t);
+        return size;
+    }
+};
+
+#endif //PACKED_DAWG_SLIDING_WINDOW_DAWG_HPP
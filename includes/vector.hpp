@@ -20,14 +20,14 @@ public:
     Vector(const std::vector<value_type>& vector){
         _size = vector.size();
         pointer = std::make_unique<value_type[]>(_size);
-        for(int i = 0; i < _size; ++i){
+        for(size_type i = 0; i < _size; ++i){
             pointer[i] = vector[i];
         }
     }
     Vector(const Vector& other){
         _size = other._size;
         pointer = std::make_unique<value_type[]>(_size);
-        for(int i = 0; i < _size; ++i){
+        for(size_type i = 0; i < _size; ++i){
             pointer[i] = other.pointer[i];
         }
     }
@@ -46,6 +46,9 @@ public:
     const value_type& operator[](std::size_t index) const{
         return pointer[index];
     }
+    const value_type* data() const{
+        return pointer.get();
+    }
     static constexpr std::uint64_t offset_bytes = sizeof(value_type*) + sizeof(size_type);
     size_type size() const{
         return _size;
@@ -5,7 +5,15 @@
 #include <type_traits>
 #include <random>
 #include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <numeric>
+#include <limits>
 #include <cxxabi.h>
+#include <pthread.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
 
 #include <cstdio>
 #include <cstdlib>
@@ -13,6 +21,14 @@
 
 #include "includes/full_text_index.hpp"
 #include "includes/dawg.hpp"
+#include "includes/mapped_dawg.hpp"
+#include "includes/segmented_index.hpp"
+#include "includes/sliding_window_dawg.hpp"
+#include "includes/rlz.hpp"
+#include "includes/document_dawg.hpp"
+#include "includes/cdawg.hpp"
+#include "includes/corpus.hpp"
+#include "includes/external_builder.hpp"
 
 
 template <typename T> std::string type_name(){
@@ -23,6 +39,19 @@ template <typename T> std::string type_name(){
     return name;
 }
 
+std::string load_text(std::string data_path, int length_limit){
+    std::clog << "loading: " << data_path << std::endl;
+    std::ifstream file(data_path);
+    assert(file.is_open());
+    std::string text = std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if(length_limit != -1){
+        assert(length_limit <= text.length());
+        text.resize(length_limit);
+    }
+    text.shrink_to_fit();
+    return text;
+}
+
 template<typename Index> requires std::is_base_of_v<FullTextIndex, Index>
 struct Benchmark {
 
@@ -32,7 +61,7 @@ struct Benchmark {
     int text_length, seed;
     std::ofstream& out_file;
 
-    void benchmark_text(const std::vector<int>& pattern_poses, int pattern_length){
+    void benchmark_text(const std::vector<int>& pattern_poses, int pattern_length, const std::string& tag = ""){
         std::clog << "matching..." << std::endl;
         // pattern matching
         auto elapsed = std::chrono::duration<int64_t, std::nano>::zero();
@@ -48,7 +77,77 @@ struct Benchmark {
         // TODO: check correctness
         double time_sec = elapsed.count() / 1'000'000'000.0;
         std::clog << "elapsed time: " << time_sec << "[sec]" << std::endl;
-        out_file << type_name<Index>() << "," << file_name << "," << text_length << "," << pattern_poses.size() << "," << pattern_length << "," << elapsed.count() << std::endl;
+        out_file << type_name<Index>() << tag << "," << file_name << "," << text_length << "," << pattern_poses.size() << "," << pattern_length << "," << elapsed.count() << std::endl;
+        std::clog << std::endl;
+    }
+
+    void benchmark_text_batched(const std::vector<int>& pattern_poses, int pattern_length){
+        std::clog << "matching (batched)..." << std::endl;
+        std::vector<std::string_view> patterns;
+        patterns.reserve(pattern_poses.size());
+        for(auto l : pattern_poses){
+            patterns.emplace_back(text_view.substr(l, pattern_length));
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        auto results = index.get_nodes(patterns);
+        auto end = std::chrono::high_resolution_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+        for([[maybe_unused]] auto& result : results){
+            assert(result.has_value());
+        }
+
+        double time_sec = elapsed.count() / 1'000'000'000.0;
+        std::clog << "elapsed time: " << time_sec << "[sec]" << std::endl;
+        out_file << type_name<Index>() << "[batched]," << file_name << "," << text_length << "," << pattern_poses.size() << "," << pattern_length << "," << elapsed.count() << std::endl;
+        std::clog << std::endl;
+    }
+
+    // splits pattern_poses into num_threads contiguous chunks, each thread pinned to its own core
+    void benchmark_text_threads(const std::vector<int>& pattern_poses, int pattern_length, int num_threads){
+        std::clog << "matching (" << num_threads << " threads)..." << std::endl;
+        int num_cores = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::int64_t> thread_elapsed(num_threads);
+        std::atomic<int> ready = 0;
+        std::atomic<bool> go = false;
+        std::vector<std::thread> threads;
+        for(int t = 0; t < num_threads; ++t){
+            threads.emplace_back([&, t]{
+                cpu_set_t cpu_set;
+                CPU_ZERO(&cpu_set);
+                CPU_SET(t % num_cores, &cpu_set);
+                pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set);
+                std::size_t begin = pattern_poses.size() * t / num_threads;
+                std::size_t end = pattern_poses.size() * (t + 1) / num_threads;
+                ++ready;
+                while(!go.load(std::memory_order_acquire));
+                auto start = std::chrono::high_resolution_clock::now();
+                for(std::size_t k = begin; k < end; ++k){
+                    [[maybe_unused]] auto result = index.get_node(text_view.substr(pattern_poses[k], pattern_length));
+                    assert(result.has_value());
+                }
+                auto finish = std::chrono::high_resolution_clock::now();
+                thread_elapsed[t] = std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start).count();
+            });
+        }
+        while(ready.load() != num_threads);
+        auto start = std::chrono::high_resolution_clock::now();
+        go.store(true, std::memory_order_release);
+        for(auto& thread : threads){
+            thread.join();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+
+        double total_qps = pattern_poses.size() / (elapsed.count() / 1'000'000'000.0);
+        double per_thread_qps = 0, min_thread_qps = std::numeric_limits<double>::infinity();
+        for(int t = 0; t < num_threads; ++t){
+            std::size_t queries = pattern_poses.size() * (t + 1) / num_threads - pattern_poses.size() * t / num_threads;
+            double qps = queries / (std::max<std::int64_t>(1, thread_elapsed[t]) / 1'000'000'000.0);
+            per_thread_qps += qps / num_threads;
+            min_thread_qps = std::min(min_thread_qps, qps);
+        }
+        std::clog << "elapsed time: " << elapsed.count() / 1'000'000'000.0 << "[sec], " << total_qps << "[queries/sec]" << std::endl;
+        out_file << type_name<Index>() << "," << file_name << "," << text_length << "," << pattern_poses.size() << "," << pattern_length << "," << num_threads << "," << elapsed.count() << "," << total_qps << "," << per_thread_qps << "," << min_thread_qps << std::endl;
         std::clog << std::endl;
     }
 
@@ -60,8 +159,7 @@ public:
         assert(out_file.is_open());
     }
 
-    void run(int num_queries, int pattern_length){
-        // generate patterns
+    std::vector<int> generate_pattern_poses(int num_queries, int pattern_length){
         std::mt19937 gen(seed);
         assert(pattern_length <= text_length);
         std::uniform_int_distribution<int> dist(0, text_length - pattern_length);
@@ -74,8 +172,59 @@ public:
         for(int i = 0; i < num_queries; ++i){
             pattern_poses[i] = dist(gen);
         }
+        return pattern_poses;
+    }
 
+    void run(int num_queries, int pattern_length){
+        auto pattern_poses = generate_pattern_poses(num_queries, pattern_length);
         benchmark_text(pattern_poses, pattern_length);
+        benchmark_text_batched(pattern_poses, pattern_length);
+    }
+
+    // the same queries with every get_lcp kernel the CPU supports, rows tagged with the kernel
+    void run_lcp_kernels(int num_queries, int pattern_length){
+        auto pattern_poses = generate_pattern_poses(num_queries, pattern_length);
+        auto best = lcp::current_kernel;
+        for(auto kernel : {lcp::Kernel::Scalar, lcp::Kernel::AVX2, lcp::Kernel::AVX512}){
+            if(lcp::supported(kernel)){
+                std::clog << "lcp kernel: " << lcp::name(kernel) << std::endl;
+                lcp::select(kernel);
+                benchmark_text(pattern_poses, pattern_length, "[" + lcp::name(kernel) + "]");
+            }
+        }
+        lcp::select(best);
+    }
+
+    // the same queries without a prefix table and with one of each k, rows tagged with k
+    void run_prefix_tables(int num_queries, const std::vector<int>& pattern_lengths){
+        std::vector<std::vector<int>> pattern_poses;
+        for(auto pattern_length : pattern_lengths){
+            pattern_poses.emplace_back(generate_pattern_poses(num_queries, pattern_length));
+        }
+        for(unsigned int k : {0u, 2u, 3u, 4u}){
+            if(k != 0){
+                auto start = std::chrono::high_resolution_clock::now();
+                std::uint64_t bytes = index.num_bytes();
+                index.build_prefix_table(k);
+                auto end = std::chrono::high_resolution_clock::now();
+                std::clog << "prefix table k=" << k << ": " << index.num_bytes() - bytes << " [bytes], " << std::chrono::duration<double>(end - start).count() << " [sec]" << std::endl;
+            }
+            for(std::size_t j = 0; j < pattern_lengths.size(); ++j){
+                benchmark_text(pattern_poses[j], pattern_lengths[j], "[k=" + std::to_string(k) + "]");
+            }
+        }
+    }
+
+    // 1, 2, 4, ... threads up to hardware_concurrency
+    void run_threads(int num_queries, int pattern_length){
+        auto pattern_poses = generate_pattern_poses(num_queries, pattern_length);
+        int max_threads = std::max(1u, std::thread::hardware_concurrency());
+        for(int num_threads = 1; ; num_threads = std::min(num_threads * 2, max_threads)){
+            benchmark_text_threads(pattern_poses, pattern_length, num_threads);
+            if(num_threads == max_threads){
+                break;
+            }
+        }
     }
 };
 
@@ -109,16 +258,474 @@ void bench(std::string data_path, std::ofstream& out_file){
 }
 
 template<typename Index> requires std::is_base_of_v<FullTextIndex, Index>
-std::pair<Index, int> get_index(std::string data_path, int length_limit){
-    std::clog << "loading: " << data_path << std::endl;
-    std::ifstream file(data_path);
-    assert(file.is_open());
-    std::string text = std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    if(length_limit != -1){
-        assert(length_limit <= text.length());
-        text.resize(length_limit);
+void _bench_threads(std::string data_path, std::ofstream& out_file){
+    std::string text = load_text(data_path, -1);
+    std::clog << "constructing...: " << text.size() << std::endl;
+    Benchmark<Index> bench(text, data_path.substr(data_path.rfind('/') + 1), out_file);
+
+    constexpr int num_queries = 100'000;
+    for(auto pattern_length : {1, 10, 100, 1000, 10000}){
+        bench.run_threads(num_queries, pattern_length);
     }
-    text.shrink_to_fit();
+}
+
+template<typename... Indexes> requires (std::is_base_of_v<FullTextIndex, Indexes> && ...)
+void bench_threads(std::string data_path, std::ofstream& out_file){
+    (_bench_threads<Indexes>(data_path, out_file), ...);
+}
+
+template<typename Index> requires std::is_base_of_v<FullTextIndex, Index>
+void _bench_prefix_table(std::string data_path, std::ofstream& out_file){
+    std::string text = load_text(data_path, -1);
+    std::clog << "constructing...: " << text.size() << std::endl;
+    Benchmark<Index> bench(text, data_path.substr(data_path.rfind('/') + 1), out_file);
+
+    constexpr int num_queries = 100'000;
+    bench.run_prefix_tables(num_queries, {1, 2, 3, 4, 5, 10, 20});
+}
+
+template<typename... Indexes> requires (std::is_base_of_v<FullTextIndex, Indexes> && ...)
+void bench_prefix_table(std::string data_path, std::ofstream& out_file){
+    (_bench_prefix_table<Indexes>(data_path, out_file), ...);
+}
+
+// matching statistics of a query built from the text with ~1% of the characters mutated
+template<typename Index> requires std::is_base_of_v<FullTextIndex, Index>
+void _bench_ms(std::string data_path, std::ofstream& out_file){
+    std::string text = load_text(data_path, -1);
+    std::string file_name = data_path.substr(data_path.rfind('/') + 1);
+    std::clog << "constructing...: " << text.size() << std::endl;
+    Index index(text);
+
+    std::mt19937 gen(0);
+    std::string query = text.substr(0, std::min<std::size_t>(text.length(), 1 << 20));
+    std::uniform_int_distribution<int> char_dist(0, 255);
+    for(auto& c : query){
+        if(gen() % 100 == 0){
+            c = static_cast<char>(char_dist(gen));
+        }
+    }
+    std::clog << "matching statistics: " << query.length() << std::endl;
+    std::uint64_t sum = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    index.matching_statistics(query, [&](std::uint64_t, std::uint64_t length){ sum += length; });
+    auto end = std::chrono::high_resolution_clock::now();
+    double sec = std::chrono::duration<double>(end - start).count();
+    double mb_per_sec = query.length() / (1024.0 * 1024.0) / sec;
+    std::clog << "time: " << sec << "[sec], " << mb_per_sec << " [MiB/s], mean length: " << static_cast<double>(sum) / query.length() << std::endl;
+    out_file << type_name<Index>() << "," << file_name << "," << text.length() << "," << query.length() << "," << sec << "," << mb_per_sec << std::endl;
+}
+
+template<typename... Indexes> requires (std::is_base_of_v<FullTextIndex, Indexes> && ...)
+void bench_ms(std::string data_path, std::ofstream& out_file){
+    (_bench_ms<Indexes>(data_path, out_file), ...);
+}
+
+
+template<typename Index> requires std::is_base_of_v<FullTextIndex, Index>
+void _bench_lcp(std::string data_path, std::ofstream& out_file){
+    std::string text = load_text(data_path, -1);
+    std::clog << "constructing...: " << text.size() << std::endl;
+    Benchmark<Index> bench(text, data_path.substr(data_path.rfind('/') + 1), out_file);
+
+    // long patterns, where get_node is dominated by get_lcp
+    for(auto pattern_length : {1000, 10000, 100000, 1000000}){
+        bench.run_lcp_kernels(std::max(100, 10'000'000 / pattern_length), std::min<int>(pattern_length, text.length()));
+    }
+}
+
+template<typename... Indexes> requires (std::is_base_of_v<FullTextIndex, Indexes> && ...)
+void bench_lcp(std::string data_path, std::ofstream& out_file){
+    (_bench_lcp<Indexes>(data_path, out_file), ...);
+}
+
+// longest_prefix in one traversal against the FullTextIndex fallback (binary search over get_node),
+// on text substrings with one byte changed at a random offset
+template<typename Index> requires std::is_base_of_v<FullTextIndex, Index>
+void _bench_prefix(std::string data_path, std::ofstream& out_file){
+    std::string text = load_text(data_path, -1);
+    std::string file_name = data_path.substr(data_path.rfind('/') + 1);
+    Index index(text);
+    constexpr int num_queries = 100'000;
+    for(int pattern_length : {20, 200, 2000}){
+        std::mt19937 gen(0);
+        std::uniform_int_distribution<int> pos_dist(0, std::max<int>(0, text.length() - pattern_length));
+        std::vector<std::string> patterns;
+        for(int i = 0; i < num_queries; ++i){
+            std::string pattern = text.substr(pos_dist(gen), pattern_length);
+            pattern[std::uniform_int_distribution<int>(0, pattern.length() - 1)(gen)] = std::uniform_int_distribution<int>(0, 255)(gen);
+            patterns.emplace_back(std::move(pattern));
+        }
+        std::vector<std::uint64_t> lengths;
+        for(bool native : {true, false}){
+            std::uint64_t total_length = 0;
+            auto start = std::chrono::high_resolution_clock::now();
+            for(const auto& pattern : patterns){
+                auto [length, node] = native ? index.longest_prefix(pattern) : index.FullTextIndex::longest_prefix(pattern);
+                total_length += length;
+                if(native){
+                    lengths.emplace_back(length);
+                }
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+            std::clog << type_name<Index>() << (native ? "" : "[binary search]") << " m=" << pattern_length << ": " << elapsed.count() / 1'000'000'000.0 << "[sec], mean length " << double(total_length) / num_queries << std::endl;
+            out_file << type_name<Index>() << (native ? "" : "[binary search]") << "," << file_name << "," << text.length() << "," << num_queries << "," << pattern_length << "," << elapsed.count() << std::endl;
+        }
+        for(int i = 0; i < num_queries; ++i){
+            assert(index.FullTextIndex::longest_prefix(patterns[i]).first == lengths[i]);
+        }
+    }
+}
+
+template<typename... Indexes> requires (std::is_base_of_v<FullTextIndex, Indexes> && ...)
+void bench_prefix(std::string data_path, std::ofstream& out_file){
+    (_bench_prefix<Indexes>(data_path, out_file), ...);
+}
+
+// RLZ against the first half of the text: the second half, and the first half with 0.1% of its bytes changed
+// (at least one to '\0', which the reference does not contain)
+template<typename Index> requires std::is_base_of_v<FullTextIndex, Index>
+void _bench_rlz(std::string data_path, std::ofstream& out_file){
+    std::string text = load_text(data_path, -1);
+    std::string file_name = data_path.substr(data_path.rfind('/') + 1);
+    std::string reference = text.substr(0, text.length() / 2);
+    // the phrases take their positions from the locate table
+    Index index(reference, true);
+
+    std::mt19937 gen(0);
+    std::string edited = reference;
+    for(std::uint64_t k = 0; k < edited.length() / 1000; ++k){
+        edited[std::uniform_int_distribution<std::uint64_t>(0, edited.length() - 1)(gen)] = std::uniform_int_distribution<int>(0, 255)(gen);
+    }
+    edited[edited.length() / 2] = '\0';
+    std::vector<std::pair<std::string, std::string>> inputs = {
+            {"second half", text.substr(text.length() / 2)},
+            {"edited", edited},
+    };
+    for(const auto& [input_name, input] : inputs){
+        std::vector<RLZFactor> sequential;
+        for(int num_threads : {1, 2, 4, 8}){
+            auto start = std::chrono::high_resolution_clock::now();
+            auto factors = num_threads == 1 ? rlz_factorize(index, input) : rlz_factorize_parallel(index, input, num_threads);
+            auto end = std::chrono::high_resolution_clock::now();
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+            if(num_threads == 1){
+                sequential = factors;
+                assert(rlz_decode(reference, factors) == input);
+            }
+            assert(factors == sequential);
+            double mb_per_sec = input.length() / (1024.0 * 1024.0) / (elapsed.count() / 1'000'000'000.0);
+            std::clog << type_name<Index>() << " " << input_name << " (" << num_threads << " threads): " << factors.size() << " phrases, " << double(input.length()) / factors.size() << " bytes/phrase, " << mb_per_sec << " [MiB/s]" << std::endl;
+            out_file << type_name<Index>() << "," << file_name << "," << input_name << "," << input.length() << "," << num_threads << "," << factors.size() << "," << elapsed.count() << "," << mb_per_sec << std::endl;
+        }
+    }
+}
+
+template<typename... Indexes> requires (std::is_base_of_v<FullTextIndex, Indexes> && ...)
+void bench_rlz(std::string data_path, std::ofstream& out_file){
+    (_bench_rlz<Indexes>(data_path, out_file), ...);
+}
+
+// DocumentDAWG over a synthetic collection of random substrings of the text:
+// document_count and document_listing for patterns taken from the documents
+template<typename Index>
+void bench_documents(std::string data_path, std::ofstream& out_file){
+    std::string text = load_text(data_path, -1);
+    std::string file_name = data_path.substr(data_path.rfind('/') + 1);
+    constexpr int num_documents = 20'000;
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<std::uint64_t> length_dist(50, 500);
+    std::vector<std::string_view> docs;
+    std::uint64_t total_length = 0;
+    for(int d = 0; d < num_documents; ++d){
+        std::uint64_t length = std::min<std::uint64_t>(length_dist(gen), text.length());
+        docs.emplace_back(std::string_view(text).substr(std::uniform_int_distribution<std::uint64_t>(0, text.length() - length)(gen), length));
+        total_length += length;
+    }
+    auto build_start = std::chrono::high_resolution_clock::now();
+    Index index(docs);
+    auto build_end = std::chrono::high_resolution_clock::now();
+    double build_sec = std::chrono::duration<double>(build_end - build_start).count();
+    std::clog << type_name<Index>() << " " << file_name << ": " << num_documents << " documents, " << total_length << " bytes, build " << build_sec << " [sec], " << index.num_bytes() << " [bytes]" << std::endl;
+
+    constexpr int num_queries = 100'000;
+    for(int pattern_length : {4, 8, 16}){
+        std::vector<std::string_view> patterns;
+        for(int i = 0; i < num_queries; ++i){
+            std::string_view doc = docs[std::uniform_int_distribution<int>(0, num_documents - 1)(gen)];
+            patterns.emplace_back(doc.substr(std::uniform_int_distribution<std::uint64_t>(0, doc.length() - pattern_length)(gen), pattern_length));
+        }
+        std::uint64_t counted = 0, listed = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for(auto pattern : patterns){
+            counted += index.document_count(pattern);
+        }
+        auto mid = std::chrono::high_resolution_clock::now();
+        for(auto pattern : patterns){
+            index.document_listing(pattern, [&](std::uint64_t){ ++listed; });
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        assert(counted == listed);
+        auto count_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(mid - start).count();
+        auto listing_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - mid).count();
+        std::clog << "m=" << pattern_length << ": document_count " << double(count_ns) / num_queries << " [ns/query], document_listing " << double(listing_ns) / num_queries << " [ns/query], " << double(listed) / num_queries << " documents/query" << std::endl;
+        out_file << file_name << "," << num_documents << "," << total_length << "," << index.num_bytes() << "," << build_sec << "," << pattern_length << "," << count_ns << "," << listing_ns << "," << listed << std::endl;
+    }
+}
+
+// Index(text) with its locate table, for the indexes where it is optional
+template<typename Index>
+Index build_with_locate(std::string_view text){
+    if constexpr(std::is_constructible_v<Index, std::string_view, bool>){
+        return Index(text, true);
+    }
+    else{
+        return Index(text);
+    }
+}
+
+// construction, memory, get_node and locate of one index on a text held in memory
+template<typename Index> requires is_full_text_index_v<Index>
+void _bench_text(const std::string& file_name, const std::string& text, const std::vector<int>& pattern_lengths, std::ofstream& out_file){
+    auto build_start = std::chrono::high_resolution_clock::now();
+    Index index = build_with_locate<Index>(text);
+    auto build_end = std::chrono::high_resolution_clock::now();
+    double build_sec = std::chrono::duration<double>(build_end - build_start).count();
+    std::clog << type_name<Index>() << " " << file_name << ": build " << build_sec << " [sec], " << index.num_bytes() / (1024.0 * 1024.0) << " [MiB]" << std::endl;
+
+    constexpr int num_queries = 10'000;
+    std::mt19937 gen(0);
+    for(int pattern_length : pattern_lengths){
+        std::uniform_int_distribution<std::uint64_t> dist(0, text.length() - pattern_length);
+        std::vector<std::string_view> patterns;
+        for(int i = 0; i < num_queries; ++i){
+            patterns.emplace_back(std::string_view(text).substr(dist(gen), pattern_length));
+        }
+        std::uint64_t occurrences = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for(auto pattern : patterns){
+            [[maybe_unused]] auto result = index.get_node(pattern);
+            assert(result.has_value());
+        }
+        auto mid = std::chrono::high_resolution_clock::now();
+        for(auto pattern : patterns){
+            index.locate(pattern, [&](std::uint64_t){ ++occurrences; });
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        // a few of the patterns again with every occurrence checked against the text, e.g. positions past 2^31
+        for(int i = 0; i < 100; ++i){
+            index.locate(patterns[i], [&](std::uint64_t pos){
+                assert(std::string_view(text).substr(pos, pattern_length) == patterns[i]);
+            });
+        }
+        auto get_node_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(mid - start).count();
+        auto locate_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - mid).count();
+        std::clog << "m=" << pattern_length << ": get_node " << double(get_node_ns) / num_queries << " [ns/query], locate " << double(locate_ns) / occurrences << " [ns/occurrence]" << std::endl;
+        out_file << type_name<Index>() << "," << file_name << "," << text.length() << "," << index.num_bytes() << "," << build_sec << "," << pattern_length << "," << get_node_ns << "," << locate_ns << "," << occurrences << std::endl;
+    }
+}
+
+template<typename... Indexes> requires (is_full_text_index_v<Indexes> && ...)
+void bench_text(const std::string& file_name, const std::string& text, const std::vector<int>& pattern_lengths, std::ofstream& out_file){
+    (_bench_text<Indexes>(file_name, text, pattern_lengths, out_file), ...);
+}
+
+// appends the text in chunks while another thread queries, then queries the settled index
+template<typename Index> requires std::is_base_of_v<FullTextIndex, Index>
+void bench_segmented(std::string data_path, std::ofstream& out_file){
+    std::string text = load_text(data_path, -1);
+    std::string file_name = data_path.substr(data_path.rfind('/') + 1);
+    constexpr int chunk_length = 4096;
+    constexpr std::uint64_t tail_limit = 1 << 16;
+    constexpr int pattern_length = 20;
+    Index index(tail_limit);
+
+    std::atomic<bool> ingesting = true;
+    std::uint64_t queries_during = 0;
+    std::thread query_thread([&]{
+        std::mt19937 gen(0);
+        while(ingesting.load()){
+            std::uint64_t length = index.size();
+            if(length < pattern_length){
+                continue;
+            }
+            std::uniform_int_distribution<std::uint64_t> dist(0, length - pattern_length);
+            [[maybe_unused]] auto result = index.count(std::string_view(text).substr(dist(gen), pattern_length));
+            assert(result > 0);
+            ++queries_during;
+        }
+    });
+    std::vector<std::int64_t> append_ns;
+    auto ingest_start = std::chrono::high_resolution_clock::now();
+    for(std::size_t pos = 0; pos < text.size(); pos += chunk_length){
+        auto start = std::chrono::high_resolution_clock::now();
+        index.append(std::string_view(text).substr(pos, chunk_length));
+        auto end = std::chrono::high_resolution_clock::now();
+        append_ns.emplace_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+    auto ingest_end = std::chrono::high_resolution_clock::now();
+    ingesting = false;
+    query_thread.join();
+    double ingest_sec = std::chrono::duration<double>(ingest_end - ingest_start).count();
+    double qps_during = queries_during / ingest_sec;
+    std::size_t segments_during = index.num_segments();
+
+    auto flush_start = std::chrono::high_resolution_clock::now();
+    index.flush();
+    auto flush_end = std::chrono::high_resolution_clock::now();
+
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<std::uint64_t> dist(0, text.size() - pattern_length);
+    constexpr int num_queries = 100'000;
+    auto start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < num_queries; ++i){
+        [[maybe_unused]] auto result = index.count(std::string_view(text).substr(dist(gen), pattern_length));
+        assert(result > 0);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double qps_after = num_queries / std::chrono::duration<double>(end - start).count();
+
+    std::sort(append_ns.begin(), append_ns.end());
+    double mean_ns = std::accumulate(append_ns.begin(), append_ns.end(), 0.0) / append_ns.size();
+    std::int64_t p99_ns = append_ns[append_ns.size() * 99 / 100];
+    std::clog << "ingest: " << text.size() / (1024.0 * 1024.0) / ingest_sec << " [MiB/s], append mean " << mean_ns << " [ns], p99 " << p99_ns << " [ns], max " << append_ns.back() << " [ns]" << std::endl;
+    std::clog << "queries: " << qps_during << " [qps] while ingesting (" << segments_during << " segments), " << qps_after << " [qps] after flush (" << index.num_segments() << " segments, flush " << std::chrono::duration<double>(flush_end - flush_start).count() << "[sec])" << std::endl;
+    out_file << file_name << "," << text.size() << "," << chunk_length << "," << tail_limit << "," << mean_ns << "," << p99_ns << "," << append_ns.back() << "," << qps_during << "," << qps_after << "," << index.num_segments() << std::endl;
+}
+
+// streams the text through a SlidingWindowDAWG: ingest throughput, peak memory, window queries
+void bench_window(std::string data_path, std::ofstream& out_file, std::uint64_t width){
+    std::string text = load_text(data_path, -1);
+    std::string file_name = data_path.substr(data_path.rfind('/') + 1);
+    constexpr int chunk_length = 4096;
+    SlidingWindowDAWG index(width);
+    std::uint64_t peak_bytes = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for(std::size_t pos = 0; pos < text.size(); pos += chunk_length){
+        index.append(std::string_view(text).substr(pos, chunk_length));
+        peak_bytes = std::max(peak_bytes, index.num_bytes());
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double mib_per_sec = text.size() / (1024.0 * 1024.0) / std::chrono::duration<double>(end - start).count();
+
+    // substrings of the window and of the text before it (mostly evicted)
+    std::string_view window = index.window();
+    constexpr int pattern_length = 20;
+    constexpr int num_queries = 100'000;
+    std::mt19937 gen(0);
+    std::vector<std::string_view> patterns;
+    for(int i = 0; i < num_queries; ++i){
+        std::string_view source = i % 2 == 0 ? window : std::string_view(text);
+        std::uint64_t length = std::min<std::uint64_t>(pattern_length, source.size());
+        patterns.emplace_back(source.substr(std::uniform_int_distribution<std::uint64_t>(0, source.size() - length)(gen), length));
+    }
+    std::uint64_t found = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for(auto pattern : patterns){
+        found += index.get_node(pattern).has_value();
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double qps = num_queries / std::chrono::duration<double>(end - start).count();
+
+    std::clog << "width " << width << ": " << mib_per_sec << " [MiB/s], peak " << peak_bytes << " [bytes] (" << double(peak_bytes) / width << " per window byte), " << qps << " [qps], found " << found << "/" << num_queries << std::endl;
+    out_file << file_name << "," << text.size() << "," << width << "," << mib_per_sec << "," << peak_bytes << "," << qps << std::endl;
+}
+
+// k-th ancestor queries on the heavy tree: walking heavy_edge_to, LevelAncestor, sdsl::bp_support_sada::level_anc
+void bench_level_ancestor(std::string data_path, std::ofstream& out_file){
+    std::string text = load_text(data_path, -1);
+    std::string file_name = data_path.substr(data_path.rfind('/') + 1);
+    HeavyPathBuilder builder = build_heavy_paths(text);
+    int n = builder.n;
+    const auto& parent = builder.heavy_edge_to;
+
+    std::vector<int> heavy_edge_to_(parent);
+    heavy_edge_to_[builder.sink] = builder.sink;
+    PackedVector heavy_edge_to(heavy_edge_to_);
+
+    // the heavy tree as balanced parentheses, as in HeavyTreeDAWGWithLABP
+    std::vector<std::vector<int>> tree(n);
+    for(int x = 0; x < n; ++x){
+        if(parent[x] != -1){
+            tree[parent[x]].emplace_back(x);
+        }
+    }
+    sdsl::bit_vector bp(2 * n, 0);
+    std::vector<int> bp_index(n);
+    std::vector<std::pair<int, bool>> stack = {{builder.sink, false}, {builder.sink, true}};
+    for(int cnt = 0; !stack.empty(); ++cnt){
+        auto [x, open] = stack.back();
+        stack.pop_back();
+        if(open){
+            bp_index[x] = cnt;
+            bp[cnt] = true;
+            for(auto y : tree[x]){
+                stack.emplace_back(y, false);
+                stack.emplace_back(y, true);
+            }
+        }
+    }
+    tree = {};
+    sdsl::bp_support_sada<> rich_bp(&bp);
+    std::ofstream null_file("/dev/null");
+    std::uint64_t bp_bytes = bp.serialize(null_file) + rich_bp.serialize(null_file);
+
+    // depth in the heavy tree = distance to the sink
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int> node_dist(0, n - 1);
+    auto make_queries = [&](int num_queries, bool short_only){
+        std::vector<std::pair<int, int>> queries;
+        for(int i = 0; i < num_queries; ++i){
+            int x = node_dist(gen);
+            int depth = builder.poses[builder.sink] - builder.poses[x];
+            int max_k = short_only ? std::min(depth, 16) : std::min<int>(depth, (1ll << std::uniform_int_distribution<int>(0, std::bit_width(unsigned(depth)))(gen)) - 1);
+            queries.emplace_back(x, std::uniform_int_distribution<int>(0, max_k)(gen));
+        }
+        return queries;
+    };
+    auto run = [&](const std::string& method, const std::string& dist, const std::vector<std::pair<int, int>>& queries, std::uint64_t bytes, auto query){
+        std::uint64_t checksum = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for(auto [x, k] : queries){
+            checksum += query(x, k);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / queries.size();
+        std::clog << method << " (" << dist << "): " << ns << " [ns/query], " << bytes << " [bytes], checksum " << checksum << std::endl;
+        out_file << method << "," << file_name << "," << dist << "," << queries.size() << "," << ns << "," << bytes << std::endl;
+    };
+
+    std::vector<LevelAncestor> level_ancestors;
+    std::vector<unsigned int> strides = {1, 2, 4, 8};
+    for(auto stride : strides){
+        level_ancestors.emplace_back(parent, stride);
+    }
+    for(bool short_only : {true, false}){
+        std::string dist = short_only ? "k<=16" : "log-uniform k";
+        auto queries = make_queries(1'000'000, short_only);
+        // the walk costs k loads, so only a prefix of the long queries
+        auto walk_queries = short_only ? queries : std::vector<std::pair<int, int>>(queries.begin(), queries.begin() + 1'000);
+        run("Linear", dist, walk_queries, heavy_edge_to.num_bytes(), [&](int x, int k){
+            for(int i = 0; i < k; ++i){
+                x = heavy_edge_to[x];
+            }
+            return x;
+        });
+        for(std::size_t s = 0; s < strides.size(); ++s){
+            run("Ladder[stride=" + std::to_string(strides[s]) + "]", dist, queries, level_ancestors[s].num_bytes(), [&](int x, int k){
+                return level_ancestors[s].ancestor(x, k);
+            });
+        }
+        run("BP", dist, queries, bp_bytes, [&](int x, int k){
+            return rich_bp.level_anc(bp_index[x], k);
+        });
+    }
+}
+
+template<typename Index> requires std::is_base_of_v<FullTextIndex, Index>
+std::pair<Index, int> get_index(std::string data_path, int length_limit){
+    std::string text = load_text(data_path, length_limit);
     Index index(text);
     return {std::move(index), text.length()};
     // return Index("text");
@@ -148,9 +755,100 @@ void bench_memory(std::string data_path, std::ofstream& out_file, int length_lim
     (_bench_memory<Indexes>(data_path, out_file, length_limit), ...);
 }
 
+// builds the image once (unless one of the current format exists for this text), then measures the cold start of the
+// mapped index. The text's hash is part of the image name, so a changed data file gets a new image.
+template<typename Index, typename MappedIndex> requires std::is_base_of_v<FullTextIndex, MappedIndex>
+void _bench_mapped(std::string data_path, std::ofstream& out_file, int length_limit){
+    std::cout << type_name<MappedIndex>() << std::endl;
+    std::string file_name = data_path.substr(data_path.rfind('/') + 1);
+    std::string text = load_text(data_path, length_limit);
+    std::string image_path = "./data/" + file_name + "." + std::to_string(length_limit) + "." + std::to_string(std::hash<std::string>{}(text)) + "." + type_name<MappedIndex>() + ".img";
+    if(!image::is_current(image_path, MappedIndex::kind)){
+        auto start = std::chrono::high_resolution_clock::now();
+        Index index(text);
+        index.save(image_path);
+        auto end = std::chrono::high_resolution_clock::now();
+        std::clog << "build + save: " << std::chrono::duration<double>(end - start).count() << "[sec]" << std::endl;
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    MappedIndex index(image_path);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::clog << "map: " << std::chrono::duration<double>(end - start).count() << "[sec]" << std::endl;
+
+    std::mt19937 gen(0);
+    constexpr int num_queries = 100'000;
+    constexpr int pattern_length = 20;
+    std::uniform_int_distribution<int> dist(0, std::max<int>(0, text.length() - pattern_length));
+    start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < num_queries; ++i){
+        [[maybe_unused]] auto result = index.get_node(std::string_view(text).substr(dist(gen), pattern_length));
+        assert(result.has_value());
+    }
+    end = std::chrono::high_resolution_clock::now();
+    std::clog << "first " << num_queries << " queries: " << std::chrono::duration<double>(end - start).count() << "[sec]" << std::endl;
+
+    out_file << type_name<MappedIndex>() << "," << file_name << "," << text.length() << "," << index.num_bytes() << std::endl;
+    std::clog << "length: " << text.length() << std::endl;
+    std::clog << "memory: " << index.num_bytes() / (1024.0 * 1024.0) << " [MiB] (mapped)" << std::endl;
+}
+
 template<typename K, typename V>
 using MapType = BinarySearchMap<K, V>;
 
+// fn() in a child process: its peak resident set in bytes and the wall time
+std::pair<std::uint64_t, double> run_in_child(const std::function<void()>& fn){
+    auto start = std::chrono::high_resolution_clock::now();
+    pid_t pid = fork();
+    assert(pid != -1);
+    if(pid == 0){
+        fn();
+        std::fflush(nullptr);
+        _exit(0);
+    }
+    int status;
+    struct rusage usage{};
+    [[maybe_unused]] pid_t res = wait4(pid, &status, 0, &usage);
+    assert(res == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    auto end = std::chrono::high_resolution_clock::now();
+    return {static_cast<std::uint64_t>(usage.ru_maxrss) * 1024, std::chrono::duration<double>(end - start).count()};
+}
+
+// HeavyPathDAWG's image built in memory (HeavyPathDAWG + save) and by build_heavy_path_image within ram_budget,
+// each in its own process for its peak resident set; the two mapped images must give the same answers
+void bench_external(std::string data_path, std::uint64_t ram_budget, std::ofstream& out_file){
+    std::string file_name = data_path.substr(data_path.rfind('/') + 1);
+    std::string memory_image = "./data/" + file_name + ".memory.img";
+    std::string external_image = "./data/" + file_name + ".external.img";
+    auto [memory_peak, memory_sec] = run_in_child([&]{
+        std::string text = load_text(data_path, -1);
+        HeavyPathDAWG<MapType>(text).save(memory_image);
+    });
+    auto [external_peak, external_sec] = run_in_child([&]{
+        build_heavy_path_image(data_path, external_image, ram_budget, "./data");
+    });
+
+    std::string text = load_text(data_path, -1);
+    MappedHeavyPathDAWG memory_index(memory_image), external_index(external_image);
+    std::mt19937 gen(0);
+    constexpr int num_queries = 100'000;
+    for(int i = 0; i < num_queries; ++i){
+        std::uint64_t length = std::min<std::uint64_t>(1 + gen() % 100, text.length());
+        std::string pattern = text.substr(gen() % (text.length() - length + 1), length);
+        if(i % 2 == 1){
+            pattern[gen() % length] = text[gen() % text.length()];
+        }
+        [[maybe_unused]] auto count = external_index.count(pattern);
+        assert(count == memory_index.count(pattern));
+        assert(external_index.longest_prefix(pattern).first == memory_index.longest_prefix(pattern).first);
+    }
+    std::clog << "in memory: " << memory_peak / (1024.0 * 1024.0) << " [MiB] peak, " << memory_sec << "[sec]" << std::endl;
+    std::clog << "external (budget " << ram_budget / (1024.0 * 1024.0) << " [MiB]): " << external_peak / (1024.0 * 1024.0) << " [MiB] peak, " << external_sec << "[sec]" << std::endl;
+    std::clog << "image: " << external_index.num_bytes() / (1024.0 * 1024.0) << " [MiB] (in memory " << memory_index.num_bytes() / (1024.0 * 1024.0) << " [MiB])" << std::endl;
+    out_file << file_name << "," << text.length() << "," << ram_budget << "," << memory_peak << "," << memory_sec << "," << external_peak << "," << external_sec << "," << external_index.num_bytes() << std::endl;
+    std::remove(memory_image.c_str());
+    std::remove(external_image.c_str());
+}
+
 int main(int argc, char** argv){
     if(argc == 1){
         std::string out_file_path = "./data/output.txt";
@@ -161,6 +859,116 @@ int main(int argc, char** argv){
             "./data/sources.10MiB",
         }){
             bench<
+                    SimpleDAWG<MapType>,
+                    HeavyTreeDAWGWithLABP<MapType>,
+                    HeavyTreeDAWGWithLABPRankFree<MapType>,
+                    HeavyTreeDAWG<MapType>,
+                    HeavyTreeDAWGWithLA<MapType>,
+                    HeavyPathDAWG<MapType>,
+                    HeavyTreeDAWGWithLABP<CSRMap>,
+                    HeavyTreeDAWG<CSRMap>,
+                    HeavyPathDAWG<CSRMap>
+            >(data_path, out_file);
+        }
+    }
+    else if(strcmp(argv[1], "threads") == 0){
+        // thread scaling of queries against one shared index
+        std::string out_file_path = "./data/output_threads.txt";
+        std::ofstream out_file(out_file_path);
+        for(auto data_path : {
+            "./data/english.10MiB",
+            "./data/dna.10MiB",
+            "./data/sources.10MiB",
+        }){
+            bench_threads<
+                    SimpleDAWG<MapType>,
+                    HeavyTreeDAWGWithLABP<MapType>,
+                    HeavyTreeDAWG<MapType>,
+                    HeavyPathDAWG<MapType>
+            >(data_path, out_file);
+        }
+    }
+    else if(strcmp(argv[1], "dna") == 0 && argc == 2){
+        // byte vs 2-bit DNA strings on the dna corpus
+        std::string out_file_path = "./data/output_dna.txt";
+        std::ofstream out_file(out_file_path);
+        bench<
+                HeavyTreeDAWG<MapType>,
+                DNAHeavyTreeDAWG<MapType>,
+                HeavyPathDAWG<MapType>,
+                DNAHeavyPathDAWG<MapType>
+        >("./data/dna.10MiB", out_file);
+    }
+    else if(strcmp(argv[1], "segmented") == 0){
+        // append-only ingestion into SegmentedIndex: append latency, query throughput during and after
+        std::string out_file_path = "./data/output_segmented.txt";
+        std::ofstream out_file(out_file_path);
+        for(auto data_path : {
+            "./data/english.10MiB",
+            "./data/dna.10MiB",
+            "./data/sources.10MiB",
+        }){
+            bench_segmented<SegmentedIndex<MapType>>(data_path, out_file);
+        }
+    }
+    else if(strcmp(argv[1], "window") == 0){
+        // SlidingWindowDAWG over each dataset as a stream, several window widths
+        std::string out_file_path = "./data/output_window.txt";
+        std::ofstream out_file(out_file_path);
+        for(auto data_path : {
+            "./data/english.10MiB",
+            "./data/dna.10MiB",
+            "./data/sources.10MiB",
+        }){
+            for(std::uint64_t width : {1u << 12, 1u << 16, 1u << 20}){
+                bench_window(data_path, out_file, width);
+            }
+        }
+    }
+    else if(strcmp(argv[1], "maps") == 0){
+        // light-edge map types against each other
+        std::string out_file_path = "./data/output_maps.txt";
+        std::ofstream out_file(out_file_path);
+        for(auto data_path : {
+            "./data/english.10MiB",
+            "./data/dna.10MiB",
+            "./data/sources.10MiB",
+        }){
+            bench<
+                    HeavyTreeDAWG<BinarySearchMap>,
+                    HeavyTreeDAWG<SIMDMap>,
+                    HeavyTreeDAWG<CSRMap>,
+                    HeavyPathDAWG<BinarySearchMap>,
+                    HeavyPathDAWG<SIMDMap>,
+                    HeavyPathDAWG<CSRMap>
+            >(data_path, out_file);
+        }
+    }
+    else if(strcmp(argv[1], "lcp") == 0){
+        // scalar / AVX2 / AVX-512 get_lcp kernels against each other
+        std::string out_file_path = "./data/output_lcp.txt";
+        std::ofstream out_file(out_file_path);
+        for(auto data_path : {
+            "./data/english.10MiB",
+            "./data/dna.10MiB",
+            "./data/sources.10MiB",
+        }){
+            bench_lcp<
+                    HeavyTreeDAWG<MapType>,
+                    HeavyPathDAWG<MapType>
+            >(data_path, out_file);
+        }
+    }
+    else if(strcmp(argv[1], "prefix") == 0){
+        // longest-prefix matches of patterns with one changed byte
+        std::string out_file_path = "./data/output_prefix.txt";
+        std::ofstream out_file(out_file_path);
+        for(auto data_path : {
+            "./data/english.10MiB",
+            "./data/dna.10MiB",
+            "./data/sources.10MiB",
+        }){
+            bench_prefix<
                     SimpleDAWG<MapType>,
                     HeavyTreeDAWGWithLABP<MapType>,
                     HeavyTreeDAWG<MapType>,
@@ -168,6 +976,170 @@ int main(int argc, char** argv){
             >(data_path, out_file);
         }
     }
+    else if(strcmp(argv[1], "prefix_table") == 0){
+        // short patterns with and without the direct lookup table for their first k characters
+        std::string out_file_path = "./data/output_prefix_table.txt";
+        std::ofstream out_file(out_file_path);
+        for(auto data_path : {
+            "./data/english.10MiB",
+            "./data/dna.10MiB",
+            "./data/sources.10MiB",
+        }){
+            bench_prefix_table<
+                    SimpleDAWG<MapType>,
+                    HeavyTreeDAWGWithLABP<MapType>,
+                    HeavyTreeDAWG<MapType>,
+                    HeavyPathDAWG<MapType>
+            >(data_path, out_file);
+        }
+    }
+    else if(strcmp(argv[1], "rlz") == 0){
+        // relative Lempel-Ziv factorisation throughput, sequential and parallel
+        std::string out_file_path = "./data/output_rlz.txt";
+        std::ofstream out_file(out_file_path);
+        for(auto data_path : {
+            "./data/english.10MiB",
+            "./data/dna.10MiB",
+            "./data/sources.10MiB",
+        }){
+            bench_rlz<
+                    HeavyTreeDAWG<MapType>,
+                    HeavyPathDAWG<MapType>
+            >(data_path, out_file);
+        }
+    }
+    else if(strcmp(argv[1], "documents") == 0){
+        // document listing and counting over a synthetic collection
+        std::string out_file_path = "./data/output_documents.txt";
+        std::ofstream out_file(out_file_path);
+        for(auto data_path : {
+            "./data/english.10MiB",
+            "./data/dna.10MiB",
+            "./data/sources.10MiB",
+        }){
+            bench_documents<DocumentDAWG<MapType>>(data_path, out_file);
+        }
+    }
+    else if(strcmp(argv[1], "cdawg") == 0){
+        // HeavyPathCDAWG against HeavyPathDAWG on each dataset and on a versioned collection of its first MiB
+        std::string out_file_path = "./data/output_cdawg.txt";
+        std::ofstream out_file(out_file_path);
+        for(auto data_path : {
+            "./data/english.10MiB",
+            "./data/dna.10MiB",
+            "./data/sources.10MiB",
+        }){
+            std::string text = load_text(data_path, -1);
+            std::string file_name = std::string(data_path).substr(std::string(data_path).rfind('/') + 1);
+            bench_text<
+                    HeavyPathDAWG<MapType>,
+                    HeavyPathCDAWG<MapType>
+            >(file_name, text, {5, 20, 100, 1000}, out_file);
+            bench_text<
+                    HeavyPathDAWG<MapType>,
+                    HeavyPathCDAWG<MapType>
+            >(file_name + ".versions", corpus::versioned(std::string_view(text).substr(0, 1 << 20), 10, 0.001, 0), {5, 20, 100, 1000}, out_file);
+        }
+    }
+    else if(strcmp(argv[1], "synthetic") == 0){
+        // generated texts (no downloaded data): text size x kind, the versioned kind over several mutation rates.
+        // Optional argv[2]: largest size in MiB (default 16)
+        std::string out_file_path = "./data/output_synthetic.txt";
+        std::ofstream out_file(out_file_path);
+        std::uint64_t max_mib = argc >= 3 ? std::stoull(argv[2]) : 16;
+        for(std::uint64_t length = 1 << 20; length <= (max_mib << 20); length *= 4){
+            std::string size = std::to_string(length >> 20) + "MiB";
+            std::vector<std::pair<std::string, std::string>> texts = {
+                    {"uniform4." + size, corpus::uniform(length, 4, 0)},
+                    {"uniform64." + size, corpus::uniform(length, 64, 0)},
+                    {"english." + size, corpus::english(length, 0)},
+                    {"dna." + size, corpus::dna(length, 0.01, 0)},
+            };
+            for(double mutation_rate : {0.0001, 0.001, 0.01}){
+                std::string text = corpus::versioned(corpus::english(length / 16, 0), 16, mutation_rate, 0);
+                text.resize(std::min<std::uint64_t>(text.size(), length));
+                texts.emplace_back("versioned" + std::to_string(mutation_rate).substr(0, 6) + "." + size, std::move(text));
+            }
+            for(const auto& [name, text] : texts){
+                bench_text<
+                        HeavyTreeDAWG<MapType>,
+                        HeavyPathDAWG<MapType>,
+                        HeavyPathCDAWG<MapType>
+                >(name, text, {20, 100}, out_file);
+            }
+        }
+    }
+    else if(strcmp(argv[1], "scaling") == 0){
+        // the 64-bit indexes on generated texts of 64 MiB, 128 MiB, ... up to argv[2] MiB (default 4096, past the
+        // 2^31 limit of the 32-bit ones), the 32-bit HeavyPathDAWG alongside while the text fits it.
+        // argv[3]: kind of text, versioned (default; 16 versions of English-like text), english or dna
+        std::string out_file_path = "./data/output_scaling.txt";
+        std::ofstream out_file(out_file_path);
+        std::uint64_t max_mib = argc >= 3 ? std::stoull(argv[2]) : 4096;
+        std::string kind = argc >= 4 ? argv[3] : "versioned";
+        for(std::uint64_t length = std::min<std::uint64_t>(64, max_mib) << 20; length <= (max_mib << 20); length *= 2){
+            std::string text;
+            if(kind == "english"){
+                text = corpus::english(length, 0);
+            }
+            else if(kind == "dna"){
+                text = corpus::dna(length, 0.01, 0);
+            }
+            else{
+                text = corpus::versioned(corpus::english(length / 16, 0), 16, 0.001, 0);
+                text.resize(std::min<std::uint64_t>(text.size(), length));
+            }
+            std::string name = kind + "." + std::to_string(length >> 20) + "MiB";
+            if(2 * text.length() < std::numeric_limits<int>::max()){
+                bench_text<HeavyPathDAWG<MapType>>(name, text, {20, 100}, out_file);
+            }
+            bench_text<
+                    HeavyPathDAWG64<MapType>,
+                    HeavyPathCDAWG64<MapType>
+            >(name, text, {20, 100}, out_file);
+        }
+    }
+    else if(strcmp(argv[1], "external") == 0){
+        // peak memory of the external-memory HeavyPathDAWG construction vs. the in-memory one
+        // argv[2]: RAM budget of the external builder in MiB (default 256), then the text files (default the 10 MiB data)
+        std::string out_file_path = "./data/output_external.txt";
+        std::ofstream out_file(out_file_path);
+        std::uint64_t ram_budget = (argc >= 3 ? std::stoull(argv[2]) : 256) << 20;
+        std::vector<std::string> data_paths(argv + std::min(argc, 3), argv + argc);
+        if(data_paths.empty()){
+            data_paths = {"./data/english.10MiB", "./data/dna.10MiB", "./data/sources.10MiB"};
+        }
+        for(auto& data_path : data_paths){
+            bench_external(data_path, ram_budget, out_file);
+        }
+    }
+    else if(strcmp(argv[1], "la") == 0){
+        // level-ancestor structures on the heavy tree
+        std::string out_file_path = "./data/output_la.txt";
+        std::ofstream out_file(out_file_path);
+        for(auto data_path : {
+            "./data/english.10MiB",
+            "./data/dna.10MiB",
+            "./data/sources.10MiB",
+        }){
+            bench_level_ancestor(data_path, out_file);
+        }
+    }
+    else if(strcmp(argv[1], "ms") == 0){
+        // streaming matching statistics over a long query
+        std::string out_file_path = "./data/output_ms.txt";
+        std::ofstream out_file(out_file_path);
+        for(auto data_path : {
+            "./data/english.10MiB",
+            "./data/dna.10MiB",
+            "./data/sources.10MiB",
+        }){
+            bench_ms<
+                    HeavyTreeDAWG<MapType>,
+                    HeavyPathDAWG<MapType>
+            >(data_path, out_file);
+        }
+    }
     else{
         std::string out_file_path = "./data/output_memory.txt";
         std::ofstream out_file(out_file_path, std::ios_base::app);
@@ -198,9 +1170,45 @@ int main(int argc, char** argv){
         else if(strcmp(argv[2], "HeavyTreeBP") == 0){
             bench_memory<HeavyTreeDAWGWithLABP<MapType>>(data_path, out_file, length_limit);
         }
+        else if(strcmp(argv[2], "HeavyTreeBPRankFree") == 0){
+            bench_memory<HeavyTreeDAWGWithLABPRankFree<MapType>>(data_path, out_file, length_limit);
+        }
+        else if(strcmp(argv[2], "HeavyTreeLA") == 0){
+            bench_memory<HeavyTreeDAWGWithLA<MapType>>(data_path, out_file, length_limit);
+        }
         else if(strcmp(argv[2], "HeavyPath") == 0){
             bench_memory<HeavyPathDAWG<MapType>>(data_path, out_file, length_limit);
         }
+        else if(strcmp(argv[2], "HeavyTreeSIMD") == 0){
+            bench_memory<HeavyTreeDAWG<SIMDMap>>(data_path, out_file, length_limit);
+        }
+        else if(strcmp(argv[2], "HeavyPathSIMD") == 0){
+            bench_memory<HeavyPathDAWG<SIMDMap>>(data_path, out_file, length_limit);
+        }
+        else if(strcmp(argv[2], "HeavyPathCDAWG") == 0){
+            bench_memory<HeavyPathCDAWG<MapType>>(data_path, out_file, length_limit);
+        }
+        else if(strcmp(argv[2], "HeavyTreeDNA") == 0){
+            bench_memory<DNAHeavyTreeDAWG<MapType>>(data_path, out_file, length_limit);
+        }
+        else if(strcmp(argv[2], "HeavyPathDNA") == 0){
+            bench_memory<DNAHeavyPathDAWG<MapType>>(data_path, out_file, length_limit);
+        }
+        else if(strcmp(argv[2], "HeavyTreeCSR") == 0){
+            bench_memory<HeavyTreeDAWG<CSRMap>>(data_path, out_file, length_limit);
+        }
+        else if(strcmp(argv[2], "HeavyTreeBPCSR") == 0){
+            bench_memory<HeavyTreeDAWGWithLABP<CSRMap>>(data_path, out_file, length_limit);
+        }
+        else if(strcmp(argv[2], "HeavyPathCSR") == 0){
+            bench_memory<HeavyPathDAWG<CSRMap>>(data_path, out_file, length_limit);
+        }
+        else if(strcmp(argv[2], "HeavyTreeMapped") == 0){
+            _bench_mapped<HeavyTreeDAWG<MapType>, MappedHeavyTreeDAWG>(data_path, out_file, length_limit);
+        }
+        else if(strcmp(argv[2], "HeavyPathMapped") == 0){
+            _bench_mapped<HeavyPathDAWG<MapType>, MappedHeavyPathDAWG>(data_path, out_file, length_limit);
+        }
     }
     return 0;
 }
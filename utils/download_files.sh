@@ -12,6 +12,6 @@ gzip -d english.gz
 gzip -d dna.gz
 head -c $CUT_SIZE dna > dna.$CUT_SIZE
 head -c $CUT_SIZE english > english.$CUT_SIZE
-head -c $CUT_SIZE source > source.$CUT_SIZE
+head -c $CUT_SIZE sources > sources.$CUT_SIZE
 )
 